@@ -0,0 +1,358 @@
+// matrix_bench.cpp — Throughput benchmarks for the Matrix/Fraction engine (no Qt dependency).
+// Usage: MatrixBench [section] [count]   (section "all" runs everything; count scales the workload)
+
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "matrix_batch.hpp"
+#include "tiled_matrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+  }
+
+  void report(const char* label, std::size_t items, const char* unit, double seconds) {
+    std::printf("%-34s %10zu %-9s %9.3f s %14.0f %s/s\n", label, items, unit, seconds,
+                seconds > 0 ? static_cast<double>(items) / seconds : 0.0, unit);
+  }
+
+  // Small-integer, diagonally dominant (hence invertible) n×n matrix.
+  Matrix randomInvertible(std::mt19937& rng, std::size_t n) {
+    std::uniform_int_distribution<int> dist(-3, 3);
+    Matrix m(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+      int rowSum = 0;
+      for (std::size_t j = 0; j < n; ++j) {
+        if (i == j) continue;
+        int v = dist(rng);
+        m(i, j) = Fraction(v, 1);
+        rowSum += v < 0 ? -v : v;
+      }
+      m(i, i) = Fraction(rowSum + 1, 1);
+    }
+    return m;
+  }
+
+  void benchBatch(std::size_t count) {
+    std::mt19937 rng(42);
+    for (std::size_t n : {3u, 4u}) {
+      std::vector<Matrix> as, bs;
+      as.reserve(count);
+      bs.reserve(count);
+      for (std::size_t i = 0; i < count; ++i) {
+        as.push_back(randomInvertible(rng, n));
+        bs.push_back(randomInvertible(rng, n));
+      }
+      const std::string shape = std::to_string(n) + "x" + std::to_string(n);
+
+      auto t0 = Clock::now();
+      for (std::size_t i = 0; i < count; ++i) (void)(as[i] * bs[i]);
+      report(("Matrix::operator* " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      MatrixBatch ba(as), bb(bs);
+      t0 = Clock::now();
+      MatrixBatch prod = ba * bb;
+      report(("MatrixBatch multiply " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < count; ++i) (void)as[i].inverse();
+      report(("Matrix::inverse " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      MatrixBatch inv = ba.inverse();
+      report(("MatrixBatch inverse " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < count; ++i) (void)as[i].determinant();
+      report(("Matrix::determinant " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      std::vector<Fraction> dets = ba.determinant();
+      report(("MatrixBatch determinant " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < count; ++i) (void)as[i].rref();
+      report(("Matrix::rref " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      t0 = Clock::now();
+      MatrixBatch reduced = ba.rref();
+      report(("MatrixBatch rref " + shape).c_str(), count, "matrices", secondsSince(t0));
+
+      const std::size_t probe = count / 2;
+      if (count > 0 && (!Matrix::approxEqual(prod.get(probe), as[probe] * bs[probe]) ||
+                        !Matrix::approxEqual(inv.get(probe), as[probe].inverse()) ||
+                        !Matrix::approxEqual(reduced.get(probe), as[probe].rref()) ||
+                        dets[probe] != as[probe].determinant()))
+        std::printf("  MISMATCH between batched and scalar results (%s)\n", shape.c_str());
+    }
+  }
+
+  Matrix randomIntegers(std::mt19937& rng, std::size_t rows, std::size_t cols) {
+    std::uniform_int_distribution<int> dist(-9, 9);
+    Matrix m(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i)
+      for (std::size_t j = 0; j < cols; ++j) m(i, j) = Fraction(dist(rng), 1);
+    return m;
+  }
+
+  // Integer fast path vs the same work in general Fraction arithmetic (entries halved).
+  void benchInteger(std::size_t count) {
+    std::mt19937 rng(7);
+    for (std::size_t n : {8u, 32u}) {
+      const std::size_t reps = std::max<std::size_t>(1, count / (n * n));
+      const Matrix a = randomIntegers(rng, n, n), b = randomIntegers(rng, n, n);
+      const Matrix ah = a / Fraction(2, 1), bh = b / Fraction(2, 1);
+      const std::string shape = std::to_string(n) + "x" + std::to_string(n);
+      auto t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) (void)(a * b);
+      report(("integer multiply " + shape).c_str(), reps, "products", secondsSince(t0));
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) (void)(ah * bh);
+      report(("fraction multiply " + shape).c_str(), reps, "products", secondsSince(t0));
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) (void)(a + b);
+      report(("integer add " + shape).c_str(), reps, "sums", secondsSince(t0));
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) (void)(ah + bh);
+      report(("fraction add " + shape).c_str(), reps, "sums", secondsSince(t0));
+      // The exact rref of a random square integer matrix past about 10x10 has entries beyond 64 bits,
+      // so the wider pass reduces an 8-row band.
+      const Matrix ra = n <= 8 ? a : randomIntegers(rng, 8, n), rah = ra / Fraction(2, 1);
+      const std::string rshape = std::to_string(ra.rows()) + "x" + std::to_string(n);
+      const std::size_t invReps = std::max<std::size_t>(1, reps / n);
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < invReps; ++i) (void)ra.rref();
+      report(("integer rref " + rshape).c_str(), invReps, "matrices", secondsSince(t0));
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < invReps; ++i) (void)rah.rref();
+      report(("fraction rref " + rshape).c_str(), invReps, "matrices", secondsSince(t0));
+    }
+  }
+
+  // Random small rationals; density is the chance an entry is nonzero. Diagonal kept nonzero.
+  Matrix randomRationals(std::mt19937& rng, std::size_t n, double density) {
+    std::uniform_int_distribution<int> num(-5, 5), den(1, 2);
+    std::bernoulli_distribution keep(density);
+    Matrix m(n, n);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+        if (i == j || keep(rng)) m(i, j) = Fraction(num(rng) | 1, den(rng));
+    return m;
+  }
+
+  // Pivot policies on the Fraction path: runtime, and peak intermediate entry size when
+  // instrumentation is compiled in. Every policy must produce the same inverse.
+  void benchPivot(std::size_t count) {
+    struct Named {
+      const char* name;
+      PivotPolicy policy;
+    };
+    const Named policies[] = {
+      {"min-bits", {PivotStrategy::SmallestBitSize, false}},
+      {"max-magnitude", {PivotStrategy::LargestMagnitude, false}},
+      {"first-nonzero", {PivotStrategy::FirstNonzero, false}},
+      {"by-sparsity", {PivotStrategy::SmallestBitSize, true}},
+    };
+    std::mt19937 rng(11);
+    for (double density : {1.0, 0.2}) {
+      for (std::size_t n : density < 1.0 ? std::vector<std::size_t>{8, 10} : std::vector<std::size_t>{4, 6}) {
+        const std::size_t reps = std::max<std::size_t>(1, count / (n * n * n));
+        std::vector<Matrix> inputs;
+        for (std::size_t i = 0; i < 16; ++i) inputs.push_back(randomRationals(rng, n, density));
+        const std::string shape = std::to_string(n) + "x" + std::to_string(n) + (density < 1.0 ? " sparse" : " dense");
+        Matrix reference(0, 0);
+        for (const Named& p : policies) {
+          instr::reset();
+          std::size_t failed = 0;
+          Matrix last(0, 0);
+          auto t0 = Clock::now();
+          for (std::size_t i = 0; i < reps; ++i) {
+            try {
+              last = inputs[i % inputs.size()].inverse(p.policy);
+            } catch (const std::runtime_error&) {
+              ++failed;
+            }
+          }
+          const double seconds = secondsSince(t0);
+          report(("inverse " + shape + " " + p.name).c_str(), reps, "matrices", seconds);
+          if (instr::enabled())
+            std::printf("  peak entry bits %llu\n", static_cast<unsigned long long>(instr::snapshot().peakEntryBits));
+          if (failed) std::printf("  %zu singular inputs skipped\n", failed);
+          if (reference.rows() == 0)
+            reference = last;
+          else if (!Matrix::approxEqual(reference, last))
+            std::printf("  MISMATCH against the min-bits result (%s)\n", shape.c_str());
+        }
+      }
+    }
+  }
+
+  // L·U with sparse unit-triangular ±1 factors: determinant 1, so the inverse stays integral and
+  // within 64 bits.
+  Matrix randomUnimodular(std::mt19937& rng, std::size_t n) {
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    Matrix L(n, n), U(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+      L(i, i) = Fraction(1, 1);
+      U(i, i) = Fraction(1, 1);
+      for (int k = 0; k < 2; ++k) {
+        const std::size_t j = pick(rng);
+        const Fraction v(rng() % 2 ? 1 : -1, 1);
+        if (j < i) L(i, j) = v;
+        if (j > i) U(i, j) = v;
+      }
+    }
+    return L * U;
+  }
+
+  // S·P·S⁻¹ for a random signed permutation P and unimodular S: dense, integral and periodic,
+  // so every power stays small and the naive product chain can be checked against pow().
+  Matrix randomPeriodic(std::mt19937& rng, std::size_t n) {
+    std::vector<std::size_t> perm(n);
+    for (std::size_t i = 0; i < n; ++i) perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), rng);
+    Matrix P(n, n);
+    for (std::size_t i = 0; i < n; ++i) P(i, perm[i]) = Fraction(rng() % 2 ? 1 : -1, 1);
+    const Matrix S = randomUnimodular(rng, n);
+    return S * P * S.inverse();
+  }
+
+  // pow() (squaring, or Cayley–Hamilton reduction once k needs more than ~3n squaring products)
+  // against k − 1 successive products.
+  void benchPow(std::size_t count) {
+    std::mt19937 rng(17);
+    const std::int64_t k = 1000;
+    const std::int64_t huge = 1000000000000000000LL;
+    for (std::size_t n : {4u, 8u, 16u}) {
+      const std::size_t reps = std::max<std::size_t>(1, count / (n * n * n));
+      const Matrix a = randomPeriodic(rng, n);
+      const std::string shape = std::to_string(n) + "x" + std::to_string(n);
+      Matrix naive(0, 0), fast(0, 0), far(0, 0);
+      auto t0 = Clock::now();
+      naive = a;
+      for (std::int64_t i = 1; i < k; ++i) naive = naive * a;
+      report(("A^1000 by 999 products " + shape).c_str(), 1, "matrices", secondsSince(t0));
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) fast = a.pow(k);
+      report(("A^1000 by pow() " + shape).c_str(), reps, "matrices", secondsSince(t0));
+      if (!Matrix::approxEqual(naive, fast))
+        std::printf("  MISMATCH between pow() and repeated products (%s)\n", shape.c_str());
+      t0 = Clock::now();
+      for (std::size_t i = 0; i < reps; ++i) far = a.pow(huge);
+      report(("A^(10^18) by pow() " + shape).c_str(), reps, "matrices", secondsSince(t0));
+      if (!Matrix::approxEqual(far * fast, a.pow(huge + k)))
+        std::printf("  MISMATCH: A^(10^18) * A^1000 != A^(10^18 + 1000) (%s)\n", shape.c_str());
+    }
+  }
+
+  void reportTiles(const char* label, const TileStats& s) {
+    std::printf("  %-32s reads %llu, writes %llu, cache hits %llu, prefetch hits %llu, peak %zu tiles\n", label,
+                static_cast<unsigned long long>(s.tileReads), static_cast<unsigned long long>(s.tileWrites),
+                static_cast<unsigned long long>(s.cacheHits), static_cast<unsigned long long>(s.prefetchHits),
+                s.peakResidentTiles);
+  }
+
+  // Out-of-core multiply and RREF through a cache of 8 tiles, checked against the in-memory
+  // Matrix. count is the matrix dimension. The RREF input is S·R for unimodular S and a small
+  // integer echelon matrix R of rank 3n/4, so rref() must recover R exactly.
+  void benchTiled(std::size_t count) {
+    std::mt19937 rng(19);
+    const std::size_t n = std::max<std::size_t>(count, 16);
+    const std::size_t tile = 16;
+    const std::size_t budget = 8 * tile * tile * sizeof(Fraction);
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string pathA = dir + "/matrix_bench_a.mtxt", pathB = dir + "/matrix_bench_b.mtxt";
+    const std::string pathC = dir + "/matrix_bench_c.mtxt";
+    const std::string shape = std::to_string(n) + "x" + std::to_string(n);
+    {
+      const Matrix a = randomIntegers(rng, n, n), b = randomIntegers(rng, n, n);
+      auto t0 = Clock::now();
+      const Matrix expected = a * b;
+      report(("in-memory multiply " + shape).c_str(), 1, "matrices", secondsSince(t0));
+      TiledMatrix ta = TiledMatrix::fromMatrix(a, pathA, tile, budget);
+      TiledMatrix tb = TiledMatrix::fromMatrix(b, pathB, tile, budget);
+      t0 = Clock::now();
+      TiledMatrix tc = ta.multiply(tb, pathC, budget);
+      report(("tiled multiply " + shape).c_str(), 1, "matrices", secondsSince(t0));
+      reportTiles("left operand", ta.stats());
+      reportTiles("right operand", tb.stats());
+      if (!Matrix::approxEqual(tc.toMatrix(), expected))
+        std::printf("  MISMATCH between tiled and in-memory multiply (%s)\n", shape.c_str());
+    }
+    {
+      const std::size_t rank = 3 * n / 4;
+      std::uniform_int_distribution<int> entry(-2, 2);
+      // Pivots in the first rank/2 columns, then a gap of n − rank pivot-free columns.
+      std::vector<std::size_t> lead(rank);
+      std::vector<bool> pivotColumn(n, false);
+      for (std::size_t i = 0; i < rank; ++i) {
+        lead[i] = i < rank / 2 ? i : i + n - rank;
+        pivotColumn[lead[i]] = true;
+      }
+      Matrix echelon(n, n);
+      for (std::size_t i = 0; i < rank; ++i) {
+        echelon(i, lead[i]) = Fraction(1, 1);
+        for (std::size_t j = lead[i] + 1; j < n; ++j)
+          if (!pivotColumn[j]) echelon(i, j) = Fraction(entry(rng), 1);
+      }
+      const Matrix a = randomUnimodular(rng, n) * echelon;
+      auto t0 = Clock::now();
+      const Matrix expected = a.rref();
+      report(("in-memory rref " + shape).c_str(), 1, "matrices", secondsSince(t0));
+      TiledMatrix ta = TiledMatrix::fromMatrix(a, pathA, tile, budget);
+      t0 = Clock::now();
+      const std::size_t found = ta.rrefInPlace();
+      report(("tiled rref " + shape).c_str(), 1, "matrices", secondsSince(t0));
+      reportTiles("rref", ta.stats());
+      if (found != rank || !Matrix::approxEqual(ta.toMatrix(), expected) || !Matrix::approxEqual(expected, echelon))
+        std::printf("  MISMATCH between tiled and in-memory rref (%s, rank %zu of %zu)\n", shape.c_str(), found, rank);
+    }
+    for (const std::string& path : {pathA, pathB, pathC}) std::remove(path.c_str());
+  }
+
+  struct Section {
+    const char* name;
+    std::size_t defaultCount;
+    std::function<void(std::size_t)> run;
+  };
+}
+
+int main(int argc, char* argv[]) {
+  const std::vector<Section> sections = {
+    {"batch", 200000, benchBatch},
+    {"integer", 2000000, benchInteger},
+    {"pivot", 200000, benchPivot},
+    {"pow", 200000, benchPow},
+    {"tiled", 128, benchTiled},
+  };
+  const char* which = argc > 1 ? argv[1] : "all";
+  const std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+  bool ran = false;
+  for (const Section& s : sections) {
+    if (std::strcmp(which, "all") != 0 && std::strcmp(which, s.name) != 0) continue;
+    std::printf("== %s ==\n", s.name);
+    s.run(count ? count : s.defaultCount);
+    ran = true;
+  }
+  if (!ran) {
+    std::fprintf(stderr, "Unknown section '%s'. Sections:", which);
+    for (const Section& s : sections) std::fprintf(stderr, " %s", s.name);
+    std::fprintf(stderr, " all\n");
+    return 1;
+  }
+  if (instr::enabled())
+    std::printf("%s\n", instr::toJson().c_str());
+  return 0;
+}
@@ -0,0 +1,367 @@
+// json.cpp — JSON parsing (recursive descent, depth-limited) and compact serialization.
+
+#include "json.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+  const int kMaxDepth = 256;
+
+  class Parser {
+  public:
+    explicit Parser(const std::string& text) : s_(text), pos_(0) {}
+
+    JsonValue document() {
+      JsonValue v = value(0);
+      skipSpace();
+      if (pos_ != s_.size()) fail("trailing characters after JSON value");
+      return v;
+    }
+
+  private:
+    const std::string& s_;
+    std::size_t pos_;
+
+    [[noreturn]] void fail(const char* what) const {
+      throw JsonError("JSON parse error at offset " + std::to_string(pos_) + ": " + what);
+    }
+
+    void skipSpace() {
+      while (pos_ < s_.size() && (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r'))
+        ++pos_;
+    }
+
+    bool consume(char c) {
+      skipSpace();
+      if (pos_ < s_.size() && s_[pos_] == c) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+
+    void expectLiteral(const char* word) {
+      for (const char* p = word; *p; ++p, ++pos_)
+        if (pos_ >= s_.size() || s_[pos_] != *p) fail("invalid literal");
+    }
+
+    JsonValue value(int depth) {
+      if (depth > kMaxDepth) fail("nesting too deep");
+      skipSpace();
+      if (pos_ >= s_.size()) fail("unexpected end of input");
+      const char c = s_[pos_];
+      if (c == '{') return object(depth);
+      if (c == '[') return array(depth);
+      if (c == '"') return JsonValue::string(string());
+      if (c == 't') {
+        expectLiteral("true");
+        return JsonValue::boolean(true);
+      }
+      if (c == 'f') {
+        expectLiteral("false");
+        return JsonValue::boolean(false);
+      }
+      if (c == 'n') {
+        expectLiteral("null");
+        return JsonValue();
+      }
+      if (c == '-' || (c >= '0' && c <= '9')) return number();
+      fail("unexpected character");
+    }
+
+    JsonValue object(int depth) {
+      ++pos_;  // '{'
+      JsonValue obj = JsonValue::object();
+      if (consume('}')) return obj;
+      do {
+        skipSpace();
+        if (pos_ >= s_.size() || s_[pos_] != '"') fail("expected member name");
+        std::string key = string();
+        if (!consume(':')) fail("expected ':'");
+        obj.set(key, value(depth + 1));
+      } while (consume(','));
+      if (!consume('}')) fail("expected ',' or '}'");
+      return obj;
+    }
+
+    JsonValue array(int depth) {
+      ++pos_;  // '['
+      JsonValue arr = JsonValue::array();
+      if (consume(']')) return arr;
+      do {
+        arr.push(value(depth + 1));
+      } while (consume(','));
+      if (!consume(']')) fail("expected ',' or ']'");
+      return arr;
+    }
+
+    JsonValue number() {
+      const std::size_t start = pos_;
+      auto digits = [&] {
+        const std::size_t from = pos_;
+        while (pos_ < s_.size() && s_[pos_] >= '0' && s_[pos_] <= '9') ++pos_;
+        return pos_ - from;
+      };
+      if (s_[pos_] == '-') ++pos_;
+      if (pos_ < s_.size() && s_[pos_] == '0')
+        ++pos_;
+      else if (digits() == 0)
+        fail("invalid number");
+      if (pos_ < s_.size() && s_[pos_] == '.') {
+        ++pos_;
+        if (digits() == 0) fail("invalid number");
+      }
+      if (pos_ < s_.size() && (s_[pos_] == 'e' || s_[pos_] == 'E')) {
+        ++pos_;
+        if (pos_ < s_.size() && (s_[pos_] == '+' || s_[pos_] == '-')) ++pos_;
+        if (digits() == 0) fail("invalid number");
+      }
+      return JsonValue::rawNumber(s_.substr(start, pos_ - start));
+    }
+
+    unsigned hex4() {
+      if (pos_ + 4 > s_.size()) fail("truncated \\u escape");
+      unsigned v = 0;
+      for (int i = 0; i < 4; ++i) {
+        const char c = s_[pos_++];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= static_cast<unsigned>(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= static_cast<unsigned>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= static_cast<unsigned>(c - 'A' + 10);
+        else fail("invalid \\u escape");
+      }
+      return v;
+    }
+
+    static void appendUtf8(std::string& out, unsigned cp) {
+      if (cp < 0x80) {
+        out += static_cast<char>(cp);
+      } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+      } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+      } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+      }
+    }
+
+    std::string string() {
+      ++pos_;  // opening quote
+      std::string out;
+      while (true) {
+        if (pos_ >= s_.size()) fail("unterminated string");
+        const char c = s_[pos_++];
+        if (c == '"') return out;
+        if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+        if (c != '\\') {
+          out += c;
+          continue;
+        }
+        if (pos_ >= s_.size()) fail("unterminated string");
+        const char e = s_[pos_++];
+        switch (e) {
+          case '"': out += '"'; break;
+          case '\\': out += '\\'; break;
+          case '/': out += '/'; break;
+          case 'b': out += '\b'; break;
+          case 'f': out += '\f'; break;
+          case 'n': out += '\n'; break;
+          case 'r': out += '\r'; break;
+          case 't': out += '\t'; break;
+          case 'u': {
+            unsigned cp = hex4();
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+              if (pos_ + 2 > s_.size() || s_[pos_] != '\\' || s_[pos_ + 1] != 'u') fail("unpaired surrogate");
+              pos_ += 2;
+              const unsigned low = hex4();
+              if (low < 0xDC00 || low > 0xDFFF) fail("unpaired surrogate");
+              cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+              fail("unpaired surrogate");
+            }
+            appendUtf8(out, cp);
+            break;
+          }
+          default: fail("invalid escape");
+        }
+      }
+    }
+  };
+}
+
+JsonValue JsonValue::boolean(bool b) {
+  JsonValue v;
+  v.type_ = Type::Bool;
+  v.bool_ = b;
+  return v;
+}
+
+JsonValue JsonValue::number(std::int64_t n) {
+  return rawNumber(std::to_string(n));
+}
+
+JsonValue JsonValue::number(double d) {
+  if (!std::isfinite(d)) return JsonValue();  // JSON has no NaN/Inf
+  char buf[32];
+  const auto res = std::to_chars(buf, buf + sizeof buf, d);
+  return rawNumber(std::string(buf, res.ptr));
+}
+
+JsonValue JsonValue::rawNumber(std::string text) {
+  JsonValue v;
+  v.type_ = Type::Number;
+  v.text_ = std::move(text);
+  return v;
+}
+
+JsonValue JsonValue::string(std::string s) {
+  JsonValue v;
+  v.type_ = Type::String;
+  v.text_ = std::move(s);
+  return v;
+}
+
+JsonValue JsonValue::array(Array items) {
+  JsonValue v;
+  v.type_ = Type::Array;
+  v.items_ = std::move(items);
+  return v;
+}
+
+JsonValue JsonValue::object(Object members) {
+  JsonValue v;
+  v.type_ = Type::Object;
+  v.members_ = std::move(members);
+  return v;
+}
+
+bool JsonValue::asBool() const {
+  if (type_ != Type::Bool) throw JsonError("JSON value is not a boolean");
+  return bool_;
+}
+
+const std::string& JsonValue::asString() const {
+  if (type_ != Type::String && type_ != Type::Number) throw JsonError("JSON value is not a string");
+  return text_;
+}
+
+bool JsonValue::isInteger() const {
+  if (type_ != Type::Number || text_.find_first_of(".eE") != std::string::npos) return false;
+  std::int64_t v;
+  const auto res = std::from_chars(text_.data(), text_.data() + text_.size(), v);
+  return res.ec == std::errc() && res.ptr == text_.data() + text_.size();
+}
+
+std::int64_t JsonValue::asInt64() const {
+  if (!isInteger()) throw JsonError("JSON value is not a 64-bit integer");
+  std::int64_t v = 0;
+  std::from_chars(text_.data(), text_.data() + text_.size(), v);
+  return v;
+}
+
+double JsonValue::asDouble() const {
+  if (type_ != Type::Number) throw JsonError("JSON value is not a number");
+  return std::strtod(text_.c_str(), nullptr);
+}
+
+const JsonValue::Array& JsonValue::asArray() const {
+  if (type_ != Type::Array) throw JsonError("JSON value is not an array");
+  return items_;
+}
+
+JsonValue::Array& JsonValue::asArray() {
+  if (type_ != Type::Array) throw JsonError("JSON value is not an array");
+  return items_;
+}
+
+const JsonValue::Object& JsonValue::asObject() const {
+  if (type_ != Type::Object) throw JsonError("JSON value is not an object");
+  return members_;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+  if (type_ != Type::Object) return nullptr;
+  for (const auto& member : members_)
+    if (member.first == key) return &member.second;
+  return nullptr;
+}
+
+JsonValue& JsonValue::set(const std::string& key, JsonValue value) {
+  if (type_ != Type::Object) throw JsonError("JSON value is not an object");
+  for (auto& member : members_)
+    if (member.first == key) return member.second = std::move(value);
+  members_.emplace_back(key, std::move(value));
+  return members_.back().second;
+}
+
+void JsonValue::push(JsonValue value) {
+  if (type_ != Type::Array) throw JsonError("JSON value is not an array");
+  items_.push_back(std::move(value));
+}
+
+void appendJsonString(std::string& out, const std::string& s) {
+  static const char kHex[] = "0123456789abcdef";
+  out += '"';
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += kHex[(c >> 4) & 0xF];
+          out += kHex[c & 0xF];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+  switch (type_) {
+    case Type::Null: out += "null"; break;
+    case Type::Bool: out += bool_ ? "true" : "false"; break;
+    case Type::Number: out += text_; break;
+    case Type::String: appendJsonString(out, text_); break;
+    case Type::Array:
+      out += '[';
+      for (std::size_t i = 0; i < items_.size(); ++i) {
+        if (i) out += ',';
+        items_[i].dumpTo(out);
+      }
+      out += ']';
+      break;
+    case Type::Object:
+      out += '{';
+      for (std::size_t i = 0; i < members_.size(); ++i) {
+        if (i) out += ',';
+        appendJsonString(out, members_[i].first);
+        out += ':';
+        members_[i].second.dumpTo(out);
+      }
+      out += '}';
+      break;
+  }
+}
+
+std::string JsonValue::dump() const {
+  std::string out;
+  dumpTo(out);
+  return out;
+}
+
+JsonValue JsonValue::parse(const std::string& text) {
+  return Parser(text).document();
+}
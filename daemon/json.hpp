@@ -0,0 +1,74 @@
+// json.hpp — Minimal JSON value, parser and writer for the JSON-RPC daemon and its load tester.
+// Numbers keep their source text so integers of any size reach Fraction parsing exactly; objects
+// keep member order. Parse errors throw JsonError with the byte offset.
+
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+class JsonError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+class JsonValue {
+public:
+  enum class Type { Null, Bool, Number, String, Array, Object };
+  using Array = std::vector<JsonValue>;
+  using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+  JsonValue() : type_(Type::Null), bool_(false) {}
+  static JsonValue boolean(bool b);
+  static JsonValue number(std::int64_t v);
+  static JsonValue number(double v);
+  static JsonValue rawNumber(std::string text);  // text must already be a valid JSON number
+  static JsonValue string(std::string s);
+  static JsonValue array(Array items = {});
+  static JsonValue object(Object members = {});
+
+  Type type() const { return type_; }
+  bool isNull() const { return type_ == Type::Null; }
+  bool isBool() const { return type_ == Type::Bool; }
+  bool isNumber() const { return type_ == Type::Number; }
+  bool isString() const { return type_ == Type::String; }
+  bool isArray() const { return type_ == Type::Array; }
+  bool isObject() const { return type_ == Type::Object; }
+
+  // Accessors throw JsonError when the type does not match.
+  bool asBool() const;
+  const std::string& asString() const;     // string contents, or a number's source text
+  bool isInteger() const;                   // number without fraction/exponent that fits int64
+  std::int64_t asInt64() const;
+  double asDouble() const;
+  const Array& asArray() const;
+  Array& asArray();
+  const Object& asObject() const;
+
+  const JsonValue* find(const std::string& key) const;  // object member or nullptr
+  JsonValue& set(const std::string& key, JsonValue value);  // adds or replaces an object member
+  void push(JsonValue value);                            // appends to an array
+
+  // Compact single-line text (no raw newlines), suitable for newline-delimited framing.
+  std::string dump() const;
+  void dumpTo(std::string& out) const;
+
+  static JsonValue parse(const std::string& text);
+
+private:
+  Type type_;
+  bool bool_;
+  std::string text_;  // string contents or number source text
+  Array items_;
+  Object members_;
+};
+
+// Appends s as a quoted, escaped JSON string.
+void appendJsonString(std::string& out, const std::string& s);
+
+#endif // JSON_HPP
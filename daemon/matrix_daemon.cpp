@@ -0,0 +1,406 @@
+// matrix_daemon.cpp — Long-running JSON-RPC 2.0 server for the Matrix engine on a Unix domain socket.
+// Usage: MatrixDaemon [--socket PATH] [--workers N] [--queue N] [--cache N] [--max-batch N]
+//
+// Framing: one JSON-RPC request (or batch array) per line; one response line per request (or
+// batch), possibly out of order across requests on the same connection — match them by id.
+// Each connection has a reader thread that answers cache hits and "stats" directly and queues
+// the rest. The queue is bounded: when it is full, readers stop reading, so clients feel
+// backpressure through their socket buffers instead of the daemon growing without limit.
+// Workers take the oldest call plus any other small batchable calls waiting behind it, so the
+// batches grow with load rather than after a fixed delay.
+
+#include "expression.hpp"
+#include "json.hpp"
+#include "matrix_batch.hpp"
+#include "matrix_service.hpp"
+#include "socket_io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+  const std::size_t kMaxLineBytes = 64 << 20;
+
+  volatile std::sig_atomic_t gStop = 0;
+  void onSignal(int) { gStop = 1; }
+
+  struct Options {
+    std::string socketPath = "/tmp/matrix-daemon.sock";
+    unsigned workers = 0;        // 0: hardware concurrency
+    std::size_t queueCapacity = 1024;
+    std::size_t cacheEntries = 4096;
+    std::size_t maxBatch = 256;
+  };
+
+  // One client socket. Workers and the reader thread all write replies; lines must not interleave.
+  class Connection {
+  public:
+    explicit Connection(int fd) : fd_(fd) {}
+    ~Connection() { ::close(fd_); }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    int fd() const { return fd_; }
+    void sendLine(std::string line) {
+      line += '\n';
+      std::lock_guard<std::mutex> lock(writeMutex_);
+      if (!broken_ && !sendAll(fd_, line)) broken_ = true;
+    }
+
+  private:
+    int fd_;
+    std::mutex writeMutex_;
+    bool broken_ = false;
+  };
+
+  // Collects the responses of one request line; a batch array is answered with one array line.
+  class Reply {
+  public:
+    Reply(std::shared_ptr<Connection> conn, bool isBatch, std::size_t parts)
+      : conn_(std::move(conn)), isBatch_(isBatch), parts_(parts), remaining_(parts) {}
+
+    // text is empty for notifications, which get no response.
+    void complete(std::size_t slot, std::string text) {
+      if (!isBatch_) {
+        if (!text.empty()) conn_->sendLine(std::move(text));
+        return;
+      }
+      parts_[slot] = std::move(text);
+      if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+      std::string out;
+      for (const std::string& part : parts_) {
+        if (part.empty()) continue;
+        out += out.empty() ? '[' : ',';
+        out += part;
+      }
+      if (!out.empty()) conn_->sendLine(out + ']');
+    }
+
+  private:
+    std::shared_ptr<Connection> conn_;
+    bool isBatch_;
+    std::vector<std::string> parts_;
+    std::atomic<std::size_t> remaining_;
+  };
+
+  struct Job {
+    RpcCall call;
+    JsonValue id;
+    bool notification = false;
+    std::shared_ptr<Reply> reply;
+    std::size_t slot = 0;
+  };
+
+  std::string responseText(const Job& job) {
+    if (job.notification) return std::string();
+    std::string out = "{\"jsonrpc\":\"2.0\",\"id\":";
+    job.id.dumpTo(out);
+    if (job.call.ok) {
+      out += ",\"result\":";
+      out += job.call.resultJson;
+    } else {
+      out += ",\"error\":{\"code\":" + std::to_string(job.call.errorCode) + ",\"message\":";
+      appendJsonString(out, job.call.errorMessage);
+      out += '}';
+    }
+    return out + '}';
+  }
+
+  void finish(std::unique_ptr<Job> job) {
+    job->reply->complete(job->slot, responseText(*job));
+  }
+
+  class JobQueue {
+  public:
+    explicit JobQueue(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+    // Blocks while the queue is full; returns false (job untouched) once the queue is closed.
+    bool push(std::unique_ptr<Job>& job) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (jobs_.size() >= capacity_) ++stalls_;
+      notFull_.wait(lock, [&] { return closed_ || jobs_.size() < capacity_; });
+      if (closed_) return false;
+      jobs_.push_back(std::move(job));
+      notEmpty_.notify_one();
+      return true;
+    }
+
+    // The oldest job plus, if it is batchable, up to maxBatch − 1 batchable jobs queued behind it.
+    // Empty once the queue is closed and drained.
+    std::vector<std::unique_ptr<Job>> popBatch(std::size_t maxBatch) {
+      std::vector<std::unique_ptr<Job>> out;
+      std::unique_lock<std::mutex> lock(mutex_);
+      notEmpty_.wait(lock, [&] { return closed_ || !jobs_.empty(); });
+      if (jobs_.empty()) return out;
+      out.push_back(std::move(jobs_.front()));
+      jobs_.pop_front();
+      if (MatrixService::batchable(out[0]->call)) {
+        for (auto it = jobs_.begin(); it != jobs_.end() && out.size() < maxBatch;) {
+          if (MatrixService::batchable((*it)->call)) {
+            out.push_back(std::move(*it));
+            it = jobs_.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+      notFull_.notify_all();
+      return out;
+    }
+
+    void close() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      notFull_.notify_all();
+      notEmpty_.notify_all();
+    }
+
+    std::size_t depth() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return jobs_.size();
+    }
+
+    std::uint64_t stalls() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return stalls_;
+    }
+
+  private:
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable notFull_, notEmpty_;
+    std::deque<std::unique_ptr<Job>> jobs_;
+    bool closed_ = false;
+    std::uint64_t stalls_ = 0;  // pushes that had to wait for room
+  };
+
+  class Server {
+  public:
+    explicit Server(const Options& options)
+      : options_(options), service_(options.cacheEntries), queue_(options.queueCapacity) {}
+
+    void startWorkers() {
+      workerCount_ = options_.workers ? options_.workers : std::max(1u, std::thread::hardware_concurrency());
+      for (unsigned i = 0; i < workerCount_; ++i) workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    // Refuses new calls, finishes queued ones, and waits for every reader thread to leave serve().
+    void stop() {
+      queue_.close();
+      for (std::thread& t : workers_) t.join();
+      workers_.clear();
+      std::unique_lock<std::mutex> lock(connMutex_);
+      for (int fd : liveFds_) ::shutdown(fd, SHUT_RDWR);
+      connDone_.wait(lock, [&] { return liveFds_.empty(); });
+    }
+
+    // Registers fd before its reader thread starts, so stop() cannot miss it.
+    void adopt(int fd) {
+      {
+        std::lock_guard<std::mutex> lock(connMutex_);
+        liveFds_.insert(fd);
+      }
+      std::thread([this, fd] { serve(fd); }).detach();
+    }
+
+  private:
+    Options options_;
+    MatrixService service_;
+    JobQueue queue_;
+    std::vector<std::thread> workers_;
+    unsigned workerCount_ = 0;
+    std::atomic<std::uint64_t> requests_{0};
+    mutable std::mutex connMutex_;
+    std::condition_variable connDone_;
+    std::set<int> liveFds_;  // sockets with a reader thread in serve()
+
+    void serve(int fd) {
+      auto conn = std::make_shared<Connection>(fd);
+      LineReader reader(fd, kMaxLineBytes);
+      std::string line;
+      while (true) {
+        const LineReader::Status status = reader.next(line);
+        if (status == LineReader::Status::TooLong) {
+          conn->sendLine(errorText(JsonValue(), rpc::kInvalidRequest, "request line too long"));
+          break;
+        }
+        if (status == LineReader::Status::Closed) break;
+        if (line.find_first_not_of(" \t") == std::string::npos) continue;
+        handleLine(conn, line);
+      }
+      // Unregister while conn still holds fd open (so the number cannot be reused meanwhile); the
+      // socket closes with the last reference, possibly after a worker sends a pending reply.
+      std::lock_guard<std::mutex> lock(connMutex_);
+      liveFds_.erase(fd);
+      connDone_.notify_all();
+    }
+
+    static std::string errorText(const JsonValue& id, int code, const std::string& message) {
+      Job job;
+      job.id = id;
+      job.call.errorCode = code;
+      job.call.errorMessage = message;
+      return responseText(job);
+    }
+
+    void workerLoop() {
+      while (true) {
+        std::vector<std::unique_ptr<Job>> jobs = queue_.popBatch(options_.maxBatch);
+        if (jobs.empty()) return;
+        std::vector<RpcCall*> calls;
+        for (auto& job : jobs) calls.push_back(&job->call);
+        service_.execute(calls);
+        for (auto& job : jobs) finish(std::move(job));
+      }
+    }
+
+    std::size_t connectionCount() const {
+      std::lock_guard<std::mutex> lock(connMutex_);
+      return liveFds_.size();
+    }
+
+    std::string statsJson() const {
+      const ServiceStats s = service_.stats();
+      char buf[512];
+      std::snprintf(buf, sizeof buf,
+                    "{\"requests\":%llu,\"calls\":%llu,\"cacheHits\":%llu,\"cacheEntries\":%zu,\"batches\":%llu,"
+                    "\"batchedCalls\":%llu,\"queueDepth\":%zu,\"queueStalls\":%llu,\"connections\":%zu,\"workers\":%u}",
+                    static_cast<unsigned long long>(requests_.load()), static_cast<unsigned long long>(s.calls),
+                    static_cast<unsigned long long>(s.cacheHits), s.cacheEntries,
+                    static_cast<unsigned long long>(s.batches), static_cast<unsigned long long>(s.batchedCalls),
+                    queue_.depth(), static_cast<unsigned long long>(queue_.stalls()), connectionCount(),
+                    workerCount_);
+      return buf;
+    }
+
+    void handleLine(const std::shared_ptr<Connection>& conn, const std::string& line) {
+      JsonValue doc;
+      try {
+        doc = JsonValue::parse(line);
+      } catch (const JsonError& e) {
+        conn->sendLine(errorText(JsonValue(), rpc::kParseError, e.what()));
+        return;
+      }
+      if (doc.isArray() && doc.asArray().empty()) {
+        conn->sendLine(errorText(JsonValue(), rpc::kInvalidRequest, "empty batch"));
+        return;
+      }
+      const bool isBatch = doc.isArray();
+      const std::size_t parts = isBatch ? doc.asArray().size() : 1;
+      auto reply = std::make_shared<Reply>(conn, isBatch, parts);
+      for (std::size_t slot = 0; slot < parts; ++slot)
+        handleRequest(reply, slot, isBatch ? doc.asArray()[slot] : doc);
+    }
+
+    void handleRequest(const std::shared_ptr<Reply>& reply, std::size_t slot, const JsonValue& request) {
+      requests_.fetch_add(1, std::memory_order_relaxed);
+      auto job = std::make_unique<Job>();
+      job->reply = reply;
+      job->slot = slot;
+      const JsonValue* id = request.find("id");
+      const JsonValue* version = request.find("jsonrpc");
+      const JsonValue* method = request.find("method");
+      const JsonValue* params = request.find("params");
+      if (id && !(id->isString() || id->isNumber() || id->isNull())) id = nullptr;
+      if (id) job->id = *id;
+      if (!request.isObject() || !version || !version->isString() || version->asString() != "2.0" || !method ||
+          !method->isString() || (params && !params->isObject() && !params->isArray())) {
+        job->call.errorCode = rpc::kInvalidRequest;
+        job->call.errorMessage = "not a JSON-RPC 2.0 request";
+        finish(std::move(job));
+        return;
+      }
+      job->notification = !id;
+      job->call.method = method->asString();
+      if (params) job->call.params = *params;
+
+      if (job->call.method == "stats") {
+        job->call.ok = true;
+        job->call.resultJson = statsJson();
+      } else if (!MatrixService::knownMethod(job->call.method)) {
+        job->call.errorCode = rpc::kMethodNotFound;
+        job->call.errorMessage = "method not found: " + job->call.method;
+      } else if (!service_.lookup(job->call)) {
+        if (queue_.push(job)) return;
+        job->call.errorCode = rpc::kShuttingDown;
+        job->call.errorMessage = "server is shutting down";
+      }
+      finish(std::move(job));
+    }
+  };
+
+  bool parseOptions(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (i + 1 >= argc) return false;
+      const char* value = argv[++i];
+      if (arg == "--socket")
+        o.socketPath = value;
+      else if (arg == "--workers")
+        o.workers = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+      else if (arg == "--queue")
+        o.queueCapacity = std::strtoull(value, nullptr, 10);
+      else if (arg == "--cache")
+        o.cacheEntries = std::strtoull(value, nullptr, 10);
+      else if (arg == "--max-batch")
+        o.maxBatch = std::max<std::size_t>(1, std::strtoull(value, nullptr, 10));
+      else
+        return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::fprintf(stderr, "Usage: %s [--socket PATH] [--workers N] [--queue N] [--cache N] [--max-batch N]\n", argv[0]);
+    return 2;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+  // The worker pool already spreads requests over the cores; batch kernels and expression nodes
+  // run on their worker.
+  MatrixBatch::setThreadCount(1);
+  MatrixSession::setThreadCount(1);
+
+  int listenFd;
+  try {
+    listenFd = listenUnix(options.socketPath, 128);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "MatrixDaemon: %s\n", e.what());
+    return 1;
+  }
+  Server server(options);
+  server.startWorkers();
+  std::fprintf(stderr, "MatrixDaemon listening on %s\n", options.socketPath.c_str());
+
+  while (!gStop) {
+    pollfd pfd{listenFd, POLLIN, 0};
+    if (::poll(&pfd, 1, 200) <= 0) continue;
+    const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) continue;
+    server.adopt(fd);
+  }
+
+  ::close(listenFd);
+  ::unlink(options.socketPath.c_str());
+  server.stop();  // queued calls are finished before the workers exit
+  return 0;
+}
@@ -0,0 +1,204 @@
+// matrix_loadtest.cpp — Load generator for MatrixDaemon: reports throughput and latency percentiles.
+// Usage: MatrixLoadTest [--socket PATH] [--connections N] [--requests N] [--size N]
+//                       [--method multiply|inverse|determinant|rref|mix] [--pipeline N] [--distinct N]
+//
+// Each connection keeps up to --pipeline requests in flight and matches responses by id, so the
+// latency of a request is measured from its send to its own response even when replies arrive out
+// of order. --distinct N draws every request from a pool of N parameter sets (exercising the
+// daemon's result cache); 0 makes every request unique.
+
+#include "json.hpp"
+#include "socket_io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    std::string socketPath = "/tmp/matrix-daemon.sock";
+    unsigned connections = 4;
+    std::size_t requests = 10000;  // total across all connections
+    std::size_t size = 4;
+    std::string method = "mix";
+    std::size_t pipeline = 8;
+    std::size_t distinct = 0;
+  };
+
+  struct ConnectionResult {
+    std::vector<double> latencies;  // seconds, one per answered request
+    std::size_t errors = 0;         // JSON-RPC error responses
+    std::string failure;            // set when the connection itself failed
+  };
+
+  const char* const kMixMethods[] = {"multiply", "inverse", "determinant", "rref"};
+
+  // Invertibility is not guaranteed; a singular matrix gets a compute error, which is counted.
+  std::string randomMatrixJson(std::mt19937_64& rng, std::size_t n) {
+    std::uniform_int_distribution<int> entry(-9, 9);
+    std::string out = "[";
+    for (std::size_t i = 0; i < n; ++i) {
+      out += i ? ",[" : "[";
+      for (std::size_t j = 0; j < n; ++j) {
+        if (j) out += ',';
+        out += std::to_string(entry(rng));
+      }
+      out += ']';
+    }
+    out += ']';
+    return out;
+  }
+
+  // The request line without its id: {"jsonrpc":"2.0","method":...,"params":...
+  std::string randomRequestPrefix(std::mt19937_64& rng, const Options& o) {
+    std::string method = o.method;
+    if (method == "mix") method = kMixMethods[rng() % 4];
+    std::string out = "{\"jsonrpc\":\"2.0\",\"method\":";
+    appendJsonString(out, method);
+    out += ",\"params\":{\"a\":" + randomMatrixJson(rng, o.size);
+    if (method == "multiply") out += ",\"b\":" + randomMatrixJson(rng, o.size);
+    out += '}';
+    return out;
+  }
+
+  void runConnection(const Options& o, std::size_t count, std::uint64_t seed,
+                     const std::vector<std::string>& pool, ConnectionResult& result) {
+    int fd;
+    try {
+      fd = connectUnix(o.socketPath);
+    } catch (const std::exception& e) {
+      result.failure = e.what();
+      return;
+    }
+    std::mt19937_64 rng(seed);
+    std::unordered_map<std::int64_t, Clock::time_point> inFlight;
+    LineReader reader(fd, 64 << 20);
+    std::string line;
+    std::size_t sent = 0;
+    result.latencies.reserve(count);
+
+    while (result.latencies.size() < count) {
+      while (sent < count && inFlight.size() < o.pipeline) {
+        std::string request = pool.empty() ? randomRequestPrefix(rng, o) : pool[rng() % pool.size()];
+        const std::int64_t id = static_cast<std::int64_t>(sent);
+        request += ",\"id\":" + std::to_string(id) + "}\n";
+        inFlight.emplace(id, Clock::now());
+        if (!sendAll(fd, request)) {
+          result.failure = "send failed";
+          ::close(fd);
+          return;
+        }
+        ++sent;
+      }
+      if (reader.next(line) != LineReader::Status::Line) {
+        result.failure = "connection closed with " + std::to_string(inFlight.size()) + " requests in flight";
+        break;
+      }
+      const Clock::time_point now = Clock::now();
+      try {
+        const JsonValue response = JsonValue::parse(line);
+        const JsonValue* id = response.find("id");
+        if (!id || !id->isInteger()) throw JsonError("response without a numeric id");
+        const auto it = inFlight.find(id->asInt64());
+        if (it == inFlight.end()) throw JsonError("response for an unknown id");
+        result.latencies.push_back(std::chrono::duration<double>(now - it->second).count());
+        inFlight.erase(it);
+        if (response.find("error")) ++result.errors;
+      } catch (const JsonError& e) {
+        result.failure = std::string("bad response: ") + e.what();
+        break;
+      }
+    }
+    ::close(fd);
+  }
+
+  double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const std::size_t i = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (i + 1 >= argc) return false;
+      const char* value = argv[++i];
+      if (arg == "--socket")
+        o.socketPath = value;
+      else if (arg == "--connections")
+        o.connections = std::max(1u, static_cast<unsigned>(std::strtoul(value, nullptr, 10)));
+      else if (arg == "--requests")
+        o.requests = std::strtoull(value, nullptr, 10);
+      else if (arg == "--size")
+        o.size = std::max<std::size_t>(1, std::strtoull(value, nullptr, 10));
+      else if (arg == "--method")
+        o.method = value;
+      else if (arg == "--pipeline")
+        o.pipeline = std::max<std::size_t>(1, std::strtoull(value, nullptr, 10));
+      else if (arg == "--distinct")
+        o.distinct = std::strtoull(value, nullptr, 10);
+      else
+        return false;
+    }
+    return o.method == "mix" || o.method == "multiply" || o.method == "inverse" || o.method == "determinant" ||
+           o.method == "rref";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::fprintf(stderr,
+                 "Usage: %s [--socket PATH] [--connections N] [--requests N] [--size N]\n"
+                 "          [--method multiply|inverse|determinant|rref|mix] [--pipeline N] [--distinct N]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::mt19937_64 rng(20240611);
+  std::vector<std::string> pool;
+  for (std::size_t i = 0; i < options.distinct; ++i) pool.push_back(randomRequestPrefix(rng, options));
+
+  std::vector<ConnectionResult> results(options.connections);
+  std::vector<std::thread> threads;
+  const Clock::time_point start = Clock::now();
+  for (unsigned c = 0; c < options.connections; ++c) {
+    // Spread the remainder so the total is exactly --requests.
+    const std::size_t count = options.requests / options.connections + (c < options.requests % options.connections);
+    threads.emplace_back(runConnection, std::cref(options), count, rng(), std::cref(pool), std::ref(results[c]));
+  }
+  for (std::thread& t : threads) t.join();
+  const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> latencies;
+  std::size_t errors = 0;
+  int status = 0;
+  for (const ConnectionResult& r : results) {
+    latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+    errors += r.errors;
+    if (!r.failure.empty()) {
+      std::fprintf(stderr, "MatrixLoadTest: %s\n", r.failure.c_str());
+      status = 1;
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  std::printf("%-12s %zu connections x pipeline %zu, %zux%zu %s, %s\n", "load", static_cast<std::size_t>(options.connections),
+              options.pipeline, options.size, options.size, options.method.c_str(),
+              options.distinct ? ("pool of " + std::to_string(options.distinct)).c_str() : "all distinct");
+  std::printf("%-12s %zu answered (%zu errors) in %.3f s\n", "requests", latencies.size(), errors, elapsed);
+  std::printf("%-12s %.0f req/s\n", "throughput", elapsed > 0 ? static_cast<double>(latencies.size()) / elapsed : 0.0);
+  std::printf("%-12s p50 %.3f ms   p99 %.3f ms   max %.3f ms\n", "latency", percentile(latencies, 0.50) * 1e3,
+              percentile(latencies, 0.99) * 1e3, latencies.empty() ? 0.0 : latencies.back() * 1e3);
+  return status;
+}
@@ -0,0 +1,365 @@
+// matrix_service.cpp — Parameter decoding, method dispatch, batching and the result cache.
+
+#include "matrix_service.hpp"
+#include "expression.hpp"
+#include "matrix.hpp"
+#include "matrix_batch.hpp"
+#include "polynomial.hpp"
+#include <charconv>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  const std::size_t kMaxDimension = 4096;
+  // MatrixBatch's inverse, determinant and rref beat per-call Matrix from 3x3 up to 8x8 (see
+  // MatrixBench batch); its multiply costs more in copying than it saves, so products run singly.
+  const std::size_t kMinBatchCells = 9;
+  const std::size_t kMaxBatchCells = 64;
+  const std::size_t kMaxCacheKeyBytes = 1 << 20;
+
+  class RpcFailure : public std::runtime_error {
+  public:
+    RpcFailure(int code, const std::string& message) : std::runtime_error(message), code_(code) {}
+    int code() const { return code_; }
+
+  private:
+    int code_;
+  };
+
+  const char* const kMethods[] = {"add", "subtract", "multiply", "scale", "pow", "transpose", "rref", "inverse",
+                                  "determinant", "trace", "charpoly", "eigenvalues", "evaluate"};
+
+  // Parameter by name (params object) or by position (params array).
+  const JsonValue& param(const RpcCall& call, const char* name, std::size_t position) {
+    const JsonValue* v = nullptr;
+    if (call.params.isObject())
+      v = call.params.find(name);
+    else if (call.params.isArray() && position < call.params.asArray().size())
+      v = &call.params.asArray()[position];
+    if (!v) throw RpcFailure(rpc::kInvalidParams, std::string("missing parameter '") + name + "'");
+    return *v;
+  }
+
+  bool parseInt(const char* first, const char* last, std::int64_t& out) {
+    const auto res = std::from_chars(first, last, out);
+    return first != last && res.ec == std::errc() && res.ptr == last;
+  }
+
+  bool allDigits(const char* first, const char* last) {
+    for (const char* p = first; p != last; ++p)
+      if (*p < '0' || *p > '9') return false;
+    return true;
+  }
+
+  // Strict entry syntax: integer, "p/q" or "[-]d.ddd" (at most 18 fractional digits).
+  Fraction parseEntry(const JsonValue& v) {
+    if (v.isNumber() && v.isInteger()) return Fraction(v.asInt64(), 1);
+    if (!v.isString() && !v.isNumber())
+      throw RpcFailure(rpc::kInvalidParams, "matrix entries must be integers or strings like \"3/4\"");
+    const std::string& s = v.asString();
+    const char* begin = s.data();
+    const char* end = begin + s.size();
+    std::int64_t num = 0, den = 1;
+    bool ok = false;
+    const std::size_t slash = s.find('/');
+    const std::size_t dot = s.find('.');
+    if (slash != std::string::npos) {
+      ok = parseInt(begin, begin + slash, num) && parseInt(begin + slash + 1, end, den) && den != 0;
+    } else if (dot != std::string::npos) {
+      const bool negative = s[0] == '-';
+      const char* wholeFirst = begin + (negative ? 1 : 0);
+      const char* fracFirst = begin + dot + 1;
+      const std::size_t digits = static_cast<std::size_t>(end - fracFirst);
+      std::int64_t whole = 0, frac = 0;
+      ok = digits >= 1 && digits <= 18 && allDigits(wholeFirst, begin + dot) && allDigits(fracFirst, end) &&
+           (wholeFirst == begin + dot || parseInt(wholeFirst, begin + dot, whole)) && parseInt(fracFirst, end, frac);
+      for (std::size_t i = 0; ok && i < digits; ++i) den *= 10;
+      ok = ok && !__builtin_mul_overflow(whole, den, &num) && !__builtin_add_overflow(num, frac, &num);
+      if (negative) num = -num;
+    } else {
+      ok = parseInt(begin, end, num);
+    }
+    if (!ok) throw RpcFailure(rpc::kInvalidParams, "invalid matrix entry \"" + s + "\"");
+    return Fraction(num, den);
+  }
+
+  Matrix parseMatrix(const JsonValue& v, const char* name) {
+    const std::string what = std::string("parameter '") + name + "'";
+    if (!v.isArray() || v.asArray().empty() || !v.asArray()[0].isArray() || v.asArray()[0].asArray().empty())
+      throw RpcFailure(rpc::kInvalidParams, what + " must be a non-empty array of rows");
+    const JsonValue::Array& rows = v.asArray();
+    const std::size_t cols = rows[0].asArray().size();
+    if (rows.size() > kMaxDimension || cols > kMaxDimension)
+      throw RpcFailure(rpc::kInvalidParams, what + " exceeds " + std::to_string(kMaxDimension) + " rows or columns");
+    Matrix m(rows.size(), cols);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      if (!rows[i].isArray() || rows[i].asArray().size() != cols)
+        throw RpcFailure(rpc::kInvalidParams, what + " has rows of different lengths");
+      const JsonValue::Array& row = rows[i].asArray();
+      for (std::size_t j = 0; j < cols; ++j) m(i, j) = parseEntry(row[j]);
+    }
+    return m;
+  }
+
+  void appendFraction(std::string& out, const Fraction& f) {
+    char buf[Fraction::kMaxChars + 2];
+    buf[0] = '"';
+    char* end = f.toChars(buf + 1, buf + sizeof buf - 1);
+    *end++ = '"';
+    out.append(buf, end);
+  }
+
+  std::string matrixJson(const Matrix& m) {
+    std::string out;
+    out.reserve(m.rows() * m.cols() * 8 + 2);
+    out += '[';
+    for (std::size_t i = 0; i < m.rows(); ++i) {
+      out += i ? ",[" : "[";
+      for (std::size_t j = 0; j < m.cols(); ++j) {
+        if (j) out += ',';
+        appendFraction(out, m(i, j));
+      }
+      out += ']';
+    }
+    out += ']';
+    return out;
+  }
+
+  std::string fractionJson(const Fraction& f) {
+    std::string out;
+    appendFraction(out, f);
+    return out;
+  }
+
+  std::string fractionListJson(const std::vector<Fraction>& values) {
+    std::string out = "[";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      if (i) out += ',';
+      appendFraction(out, values[i]);
+    }
+    return out + "]";
+  }
+
+  // Shape of a matrix parameter without decoding it; false if it is not a rows array.
+  bool peekShape(const RpcCall& call, const char* name, std::size_t position, std::size_t& rows, std::size_t& cols) {
+    const JsonValue* v = nullptr;
+    if (call.params.isObject())
+      v = call.params.find(name);
+    else if (call.params.isArray() && position < call.params.asArray().size())
+      v = &call.params.asArray()[position];
+    if (!v || !v->isArray() || v->asArray().empty() || !v->asArray()[0].isArray()) return false;
+    rows = v->asArray().size();
+    cols = v->asArray()[0].asArray().size();
+    return true;
+  }
+
+  std::string batchKey(const RpcCall& call) {
+    std::size_t r = 0, c = 0;
+    peekShape(call, "a", 0, r, c);
+    return call.method + ':' + std::to_string(r) + 'x' + std::to_string(c);
+  }
+}
+
+MatrixService::MatrixService(std::size_t cacheCapacity) : capacity_(cacheCapacity) {}
+
+bool MatrixService::knownMethod(const std::string& method) {
+  for (const char* m : kMethods)
+    if (method == m) return true;
+  return false;
+}
+
+bool MatrixService::batchable(const RpcCall& call) {
+  const bool square = call.method == "inverse" || call.method == "determinant";
+  if (!square && call.method != "rref") return false;
+  std::size_t r = 0, c = 0;
+  return peekShape(call, "a", 0, r, c) && r * c >= kMinBatchCells && r * c <= kMaxBatchCells && (!square || r == c);
+}
+
+bool MatrixService::lookup(RpcCall& call) {
+  call.cacheKey.clear();
+  if (capacity_ == 0 || !knownMethod(call.method)) return false;
+  std::string key = call.method;
+  key += '\n';
+  call.params.dumpTo(key);
+  if (key.size() > kMaxCacheKeyBytes) return false;
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  auto it = index_.find(key);
+  call.cacheKey = std::move(key);
+  if (it == index_.end()) return false;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  call.ok = true;
+  call.resultJson = it->second->second;
+  cacheHits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void MatrixService::store(const RpcCall& call) {
+  if (!call.ok || call.cacheKey.empty() || capacity_ == 0) return;
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  auto it = index_.find(call.cacheKey);
+  if (it != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+  lru_.emplace_front(call.cacheKey, call.resultJson);
+  index_[call.cacheKey] = lru_.begin();
+  if (lru_.size() > capacity_) {
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+void MatrixService::execute(const std::vector<RpcCall*>& calls) {
+  std::map<std::string, std::vector<RpcCall*>> groups;
+  std::vector<RpcCall*> singles;
+  for (RpcCall* call : calls) {
+    if (batchable(*call))
+      groups[batchKey(*call)].push_back(call);
+    else
+      singles.push_back(call);
+  }
+  for (auto& entry : groups) {
+    if (entry.second.size() < 2 || !executeBatch(entry.second))
+      singles.insert(singles.end(), entry.second.begin(), entry.second.end());
+  }
+  for (RpcCall* call : singles) executeOne(*call);
+  for (RpcCall* call : calls) store(*call);
+}
+
+bool MatrixService::executeBatch(const std::vector<RpcCall*>& group) {
+  const std::string& method = group[0]->method;
+  std::vector<RpcCall*> members;
+  std::vector<Matrix> as;
+  for (RpcCall* call : group) {
+    try {
+      as.push_back(parseMatrix(param(*call, "a", 0), "a"));
+      members.push_back(call);
+    } catch (const RpcFailure&) {
+      executeOne(*call);  // reports the decoding error
+    }
+  }
+  if (members.size() < 2) {
+    for (RpcCall* call : members) executeOne(*call);
+    return true;
+  }
+  try {
+    MatrixBatch batchA(as);
+    std::vector<std::string> results(members.size());
+    if (method == "determinant") {
+      const std::vector<Fraction> dets = batchA.determinant();
+      for (std::size_t i = 0; i < members.size(); ++i) results[i] = fractionJson(dets[i]);
+    } else if (method == "rref") {
+      const MatrixBatch reduced = batchA.rref();
+      for (std::size_t i = 0; i < members.size(); ++i) results[i] = matrixJson(reduced.get(i));
+    } else {  // inverse: singular members are answered one by one, which reports the error
+      const std::vector<Fraction> dets = batchA.determinant();
+      std::vector<std::size_t> invertible;
+      std::vector<Matrix> subset;
+      for (std::size_t i = 0; i < members.size(); ++i) {
+        if (dets[i].isZero()) continue;
+        invertible.push_back(i);
+        subset.push_back(as[i]);
+      }
+      if (!subset.empty()) {
+        const MatrixBatch inv = MatrixBatch(subset).inverse();
+        for (std::size_t k = 0; k < invertible.size(); ++k) results[invertible[k]] = matrixJson(inv.get(k));
+      }
+    }
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < members.size(); ++i) {
+      if (results[i].empty()) {
+        executeOne(*members[i]);
+        continue;
+      }
+      members[i]->ok = true;
+      members[i]->resultJson = std::move(results[i]);
+      calls_.fetch_add(1, std::memory_order_relaxed);
+      batchedCalls_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+void MatrixService::executeOne(RpcCall& call) {
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  call.ok = false;
+  try {
+    const std::string& m = call.method;
+    if (m == "add" || m == "subtract" || m == "multiply") {
+      const Matrix a = parseMatrix(param(call, "a", 0), "a");
+      const Matrix b = parseMatrix(param(call, "b", 1), "b");
+      call.resultJson = matrixJson(m == "add" ? a + b : m == "subtract" ? a - b : a * b);
+    } else if (m == "scale") {
+      const Matrix a = parseMatrix(param(call, "a", 0), "a");
+      call.resultJson = matrixJson(a * parseEntry(param(call, "scalar", 1)));
+    } else if (m == "pow") {
+      const Matrix a = parseMatrix(param(call, "a", 0), "a");
+      const JsonValue& k = param(call, "k", 1);
+      if (!k.isNumber() || !k.isInteger())
+        throw RpcFailure(rpc::kInvalidParams, "parameter 'k' must be an integer in the int64 range");
+      call.resultJson = matrixJson(a.pow(k.asInt64()));
+    } else if (m == "transpose" || m == "rref" || m == "inverse") {
+      const Matrix a = parseMatrix(param(call, "a", 0), "a");
+      call.resultJson = matrixJson(m == "transpose" ? a.transpose() : m == "rref" ? a.rref() : a.inverse());
+    } else if (m == "determinant" || m == "trace") {
+      const Matrix a = parseMatrix(param(call, "a", 0), "a");
+      call.resultJson = fractionJson(m == "determinant" ? a.determinant() : a.trace());
+    } else if (m == "charpoly") {
+      const Polynomial p = parseMatrix(param(call, "a", 0), "a").charpoly();
+      std::string out = "{\"coefficients\":" + fractionListJson(p) + ",\"text\":";
+      appendJsonString(out, poly::toString(p, "x"));
+      call.resultJson = out + "}";
+    } else if (m == "eigenvalues") {
+      const Eigenvalues ev = parseMatrix(param(call, "a", 0), "a").eigenvalues();
+      JsonValue approx = JsonValue::array();
+      for (const auto& z : ev.approximate)
+        approx.push(JsonValue::array({JsonValue::number(z.real()), JsonValue::number(z.imag())}));
+      call.resultJson = "{\"exact\":" + fractionListJson(ev.exact) + ",\"approximate\":" + approx.dump() + "}";
+    } else if (m == "evaluate") {
+      const JsonValue& matrices = param(call, "matrices", 0);
+      const JsonValue& expression = param(call, "expression", 1);
+      if (!matrices.isObject() || !expression.isString())
+        throw RpcFailure(rpc::kInvalidParams, "evaluate needs a 'matrices' object and an 'expression' string");
+      MatrixSession session;
+      for (const auto& member : matrices.asObject()) {
+        if (!MatrixSession::isValidName(member.first))
+          throw RpcFailure(rpc::kInvalidParams, "invalid matrix name '" + member.first + "'");
+        session.set(member.first, parseMatrix(member.second, member.first.c_str()));
+      }
+      const ExpressionValue value = session.evaluate(expression.asString());
+      call.resultJson = value.isScalar ? fractionJson(value.scalar) : matrixJson(value.matrix);
+    } else {
+      throw RpcFailure(rpc::kMethodNotFound, "method not found: " + m);
+    }
+    call.ok = true;
+  } catch (const RpcFailure& e) {
+    call.errorCode = e.code();
+    call.errorMessage = e.what();
+  } catch (const JsonError& e) {
+    call.errorCode = rpc::kInvalidParams;
+    call.errorMessage = e.what();
+  } catch (const std::invalid_argument& e) {
+    call.errorCode = rpc::kInvalidParams;
+    call.errorMessage = e.what();
+  } catch (const std::runtime_error& e) {
+    call.errorCode = rpc::kComputeError;
+    call.errorMessage = e.what();
+  } catch (const std::exception& e) {
+    call.errorCode = rpc::kInternalError;
+    call.errorMessage = e.what();
+  }
+}
+
+ServiceStats MatrixService::stats() const {
+  ServiceStats s;
+  s.calls = calls_.load(std::memory_order_relaxed);
+  s.cacheHits = cacheHits_.load(std::memory_order_relaxed);
+  s.batches = batches_.load(std::memory_order_relaxed);
+  s.batchedCalls = batchedCalls_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  s.cacheEntries = lru_.size();
+  return s;
+}
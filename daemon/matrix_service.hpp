@@ -0,0 +1,91 @@
+// matrix_service.hpp — JSON-RPC methods over the Matrix engine, with an LRU result cache and
+// batched execution: small same-shaped inverse/determinant/rref calls that are pending
+// together run as one MatrixBatch kernel instead of one Matrix operation each.
+//
+// Matrices travel as arrays of rows; an entry is a JSON integer or a string "p/q", "p" or "d.ddd".
+// Results use strings for every entry so no value passes through a double.
+//
+//   add, subtract, multiply      {"a": M, "b": M}                 -> M
+//   scale                        {"a": M, "scalar": s}            -> M
+//   pow                          {"a": M, "k": integer}           -> M (A^k; k < 0 inverts)
+//   transpose, rref, inverse     {"a": M}                         -> M
+//   determinant, trace           {"a": M}                         -> "p/q"
+//   charpoly                     {"a": M}                         -> {"coefficients": [...], "text": "..."}
+//   eigenvalues                  {"a": M}                         -> {"exact": [...], "approximate": [[re, im]...]}
+//   evaluate                     {"matrices": {"A": M, ...}, "expression": "..."}  -> M or "p/q"
+// Params may also be positional, in the order listed.
+
+#ifndef MATRIX_SERVICE_HPP
+#define MATRIX_SERVICE_HPP
+
+#include "json.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// JSON-RPC 2.0 error codes (the -32000 range is implementation-defined).
+namespace rpc {
+  const int kParseError = -32700;
+  const int kInvalidRequest = -32600;
+  const int kMethodNotFound = -32601;
+  const int kInvalidParams = -32602;
+  const int kInternalError = -32603;
+  const int kComputeError = -32000;  // e.g. singular matrix
+  const int kShuttingDown = -32001;
+}
+
+// One call: inputs from the request, outputs filled in by MatrixService.
+struct RpcCall {
+  std::string method;
+  JsonValue params;
+  std::string cacheKey;    // set by lookup(); empty when the call is not cacheable
+  bool ok = false;
+  std::string resultJson;  // serialized result when ok
+  int errorCode = 0;
+  std::string errorMessage;
+};
+
+struct ServiceStats {
+  std::uint64_t calls = 0;         // calls executed (cache hits excluded)
+  std::uint64_t cacheHits = 0;
+  std::uint64_t batches = 0;       // MatrixBatch kernel launches
+  std::uint64_t batchedCalls = 0;  // calls answered by those launches
+  std::size_t cacheEntries = 0;
+};
+
+class MatrixService {
+public:
+  explicit MatrixService(std::size_t cacheCapacity);
+
+  static bool knownMethod(const std::string& method);
+  // Small inverse/determinant/rref calls that may be grouped into one batch kernel.
+  static bool batchable(const RpcCall& call);
+
+  // Answers call from the cache if possible (ok + resultJson set); also sets call.cacheKey.
+  bool lookup(RpcCall& call);
+  // Runs every call, batching where possible, and caches the successful results. Thread-safe.
+  void execute(const std::vector<RpcCall*>& calls);
+
+  ServiceStats stats() const;
+
+private:
+  std::size_t capacity_;
+  mutable std::mutex cacheMutex_;
+  std::list<std::pair<std::string, std::string>> lru_;  // most recent first: (key, resultJson)
+  std::unordered_map<std::string, std::list<std::pair<std::string, std::string>>::iterator> index_;
+  std::atomic<std::uint64_t> calls_{0};
+  std::atomic<std::uint64_t> cacheHits_{0};
+  std::atomic<std::uint64_t> batches_{0};
+  std::atomic<std::uint64_t> batchedCalls_{0};
+
+  void executeOne(RpcCall& call);
+  bool executeBatch(const std::vector<RpcCall*>& group);  // false: run the calls one by one instead
+  void store(const RpcCall& call);
+};
+
+#endif // MATRIX_SERVICE_HPP
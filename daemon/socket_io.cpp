@@ -0,0 +1,84 @@
+// socket_io.cpp — Unix domain socket setup, full writes and line framing.
+
+#include "socket_io.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+  sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof addr.sun_path)
+      throw std::runtime_error("Socket path is empty or longer than " + std::to_string(sizeof addr.sun_path - 1) +
+                               " bytes: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+  }
+
+  [[noreturn]] void throwErrno(const std::string& what, int fd) {
+    const int err = errno;
+    if (fd >= 0) ::close(fd);
+    throw std::runtime_error(what + ": " + std::strerror(err));
+  }
+}
+
+int listenUnix(const std::string& path, int backlog) {
+  const sockaddr_un addr = unixAddress(path);
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) throwErrno("socket", -1);
+  ::unlink(path.c_str());
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) throwErrno("bind " + path, fd);
+  if (::listen(fd, backlog) != 0) throwErrno("listen " + path, fd);
+  return fd;
+}
+
+int connectUnix(const std::string& path) {
+  const sockaddr_un addr = unixAddress(path);
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) throwErrno("socket", -1);
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) throwErrno("connect " + path, fd);
+  return fd;
+}
+
+bool sendAll(int fd, const char* data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+LineReader::Status LineReader::next(std::string& line) {
+  std::size_t scanFrom = start_;
+  while (true) {
+    const std::size_t nl = buffer_.find('\n', scanFrom);
+    if (nl != std::string::npos) {
+      std::size_t end = nl;
+      if (end > start_ && buffer_[end - 1] == '\r') --end;
+      line.assign(buffer_, start_, end - start_);
+      start_ = nl + 1;
+      return Status::Line;
+    }
+    if (buffer_.size() - start_ > maxLine_) return Status::TooLong;
+    // Compact before reading more so the buffer does not grow with everything already consumed.
+    if (start_ > 0) {
+      buffer_.erase(0, start_);
+      start_ = 0;
+    }
+    scanFrom = buffer_.size();
+    char chunk[64 * 1024];
+    const ssize_t n = ::recv(fd_, chunk, sizeof chunk, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return Status::Closed;
+    buffer_.append(chunk, static_cast<std::size_t>(n));
+  }
+}
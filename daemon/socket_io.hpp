@@ -0,0 +1,31 @@
+// socket_io.hpp — Unix domain stream sockets with newline-delimited message framing (POSIX only).
+
+#ifndef SOCKET_IO_HPP
+#define SOCKET_IO_HPP
+
+#include <cstddef>
+#include <string>
+
+// Both return a socket descriptor, or throw std::runtime_error with errno text.
+int listenUnix(const std::string& path, int backlog);  // replaces a stale socket file at path
+int connectUnix(const std::string& path);
+
+// Writes all of data (retrying short writes, never raising SIGPIPE); false if the peer is gone.
+bool sendAll(int fd, const char* data, std::size_t size);
+inline bool sendAll(int fd, const std::string& data) { return sendAll(fd, data.data(), data.size()); }
+
+// Splits a byte stream into lines ('\n'-terminated, an optional '\r' stripped).
+class LineReader {
+public:
+  LineReader(int fd, std::size_t maxLine) : fd_(fd), maxLine_(maxLine), start_(0) {}
+  enum class Status { Line, Closed, TooLong };
+  Status next(std::string& line);
+
+private:
+  int fd_;
+  std::size_t maxLine_;
+  std::string buffer_;
+  std::size_t start_;  // first unconsumed byte of buffer_
+};
+
+#endif // SOCKET_IO_HPP
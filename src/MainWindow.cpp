@@ -2,8 +2,16 @@
 
 #include "MainWindow.hpp"
 #include "fraction.hpp"
+#include "instrumentation.hpp"
+#include "matrix_batch.hpp"
+#include "matrix_export.hpp"
+#include "tiled_matrix.hpp"
 #include <QApplication>
+#include <QClipboard>
 #include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QLineEdit>
 #include <QFormLayout>
 #include <QGridLayout>
@@ -11,6 +19,7 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
+#include <QPlainTextEdit>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QSpinBox>
@@ -19,11 +28,20 @@
 #include <QVBoxLayout>
 #include <QWidget>
 #include <Qt>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
 
 namespace {
   const int kMaxRowsCols = 20;
   const int kDefaultRows = 2;
   const int kDefaultCols = 2;
+  // Larger results are kept for Export/Copy but not turned into table items.
+  const std::size_t kMaxDisplayCells = 10000;
 }
 
 MainWindow::MainWindow(QWidget* parent)
@@ -36,8 +54,12 @@ MainWindow::MainWindow(QWidget* parent)
   , tableB_(nullptr)
   , resultTable_(nullptr)
   , scalarEdit_(nullptr)
+  , expressionEdit_(nullptr)
+  , sessionLabel_(nullptr)
+  , diagnosticsView_(nullptr)
   , statusBar_(nullptr)
   , centralWidget_(nullptr)
+  , lastResult_(0, 0)
 {
   setWindowTitle(tr("Matrix Calculator"));
   setMinimumSize(900, 600);
@@ -59,6 +81,7 @@ void MainWindow::setupUi() {
   buildMatrixInputs();
   buildOperationPanel();
   buildResultView();
+  buildDiagnosticsPanel();
 
   statusBar_ = new QStatusBar(this);
   setStatusBar(statusBar_);
@@ -163,12 +186,36 @@ void MainWindow::buildOperationPanel() {
   addBtn(tr("B × scalar"), &MainWindow::performScalarMultiplyB);
   addBtn(tr("A / scalar"), &MainWindow::performScalarDivideA);
   addBtn(tr("B / scalar"), &MainWindow::performScalarDivideB);
+  addBtn(tr("A^k (k = scalar)"), &MainWindow::performPowerA);
+  addBtn(tr("B^k (k = scalar)"), &MainWindow::performPowerB);
   addBtn(tr("RREF(A)"), &MainWindow::performRREFOnA);
   addBtn(tr("RREF(B)"), &MainWindow::performRREFOnB);
   addBtn(tr("Inverse(A)"), &MainWindow::performInverseA);
   addBtn(tr("Inverse(B)"), &MainWindow::performInverseB);
+  addBtn(tr("det(A)"), &MainWindow::performDeterminantA);
+  addBtn(tr("det(B)"), &MainWindow::performDeterminantB);
+  addBtn(tr("trace(A)"), &MainWindow::performTraceA);
+  addBtn(tr("trace(B)"), &MainWindow::performTraceB);
+  addBtn(tr("Char. polynomial(A)"), &MainWindow::performCharpolyA);
+  addBtn(tr("Char. polynomial(B)"), &MainWindow::performCharpolyB);
+  addBtn(tr("Eigenvalues(A)"), &MainWindow::performEigenvaluesA);
+  addBtn(tr("Eigenvalues(B)"), &MainWindow::performEigenvaluesB);
   v->addLayout(grid);
 
+  QHBoxLayout* exprRow = new QHBoxLayout();
+  expressionEdit_ = new QLineEdit();
+  expressionEdit_->setPlaceholderText(tr("e.g. inv(A)*B*A + 2*B^T   or   C = A*B"));
+  QPushButton* evalBtn = new QPushButton(tr("Evaluate"));
+  connect(evalBtn, &QPushButton::clicked, this, &MainWindow::performExpression);
+  connect(expressionEdit_, &QLineEdit::returnPressed, this, &MainWindow::performExpression);
+  exprRow->addWidget(new QLabel(tr("Expression:")));
+  exprRow->addWidget(expressionEdit_, 1);
+  exprRow->addWidget(evalBtn);
+  v->addLayout(exprRow);
+  sessionLabel_ = new QLabel();
+  v->addWidget(sessionLabel_);
+  updateSessionNames();
+
   static_cast<QVBoxLayout*>(centralWidget_->layout())->addWidget(opsGroup);
 }
 
@@ -179,9 +226,41 @@ void MainWindow::buildResultView() {
   resultTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
   resultTable_->setMinimumSize(200, 120);
   v->addWidget(resultTable_);
+  QHBoxLayout* buttons = new QHBoxLayout();
+  QPushButton* exportBtn = new QPushButton(tr("Export…"));
+  QPushButton* copyCsvBtn = new QPushButton(tr("Copy as CSV"));
+  QPushButton* copyLatexBtn = new QPushButton(tr("Copy as LaTeX"));
+  connect(exportBtn, &QPushButton::clicked, this, &MainWindow::exportResult);
+  connect(copyCsvBtn, &QPushButton::clicked, this, &MainWindow::copyResultCsv);
+  connect(copyLatexBtn, &QPushButton::clicked, this, &MainWindow::copyResultLatex);
+  buttons->addWidget(exportBtn);
+  buttons->addWidget(copyCsvBtn);
+  buttons->addWidget(copyLatexBtn);
+  buttons->addStretch();
+  v->addLayout(buttons);
   static_cast<QVBoxLayout*>(centralWidget_->layout())->addWidget(resultGroup);
 }
 
+void MainWindow::buildDiagnosticsPanel() {
+  QGroupBox* diagGroup = new QGroupBox(tr("Diagnostics"));
+  QVBoxLayout* v = new QVBoxLayout(diagGroup);
+  diagnosticsView_ = new QPlainTextEdit();
+  diagnosticsView_->setReadOnly(true);
+  diagnosticsView_->setMaximumHeight(110);
+  v->addWidget(diagnosticsView_);
+  QHBoxLayout* buttons = new QHBoxLayout();
+  QPushButton* exportBtn = new QPushButton(tr("Export JSON…"));
+  QPushButton* resetBtn = new QPushButton(tr("Reset counters"));
+  connect(exportBtn, &QPushButton::clicked, this, &MainWindow::exportDiagnosticsJson);
+  connect(resetBtn, &QPushButton::clicked, this, &MainWindow::resetDiagnostics);
+  buttons->addWidget(exportBtn);
+  buttons->addWidget(resetBtn);
+  buttons->addStretch();
+  v->addLayout(buttons);
+  static_cast<QVBoxLayout*>(centralWidget_->layout())->addWidget(diagGroup);
+  updateDiagnostics();
+}
+
 Matrix MainWindow::loadMatrixFromTable(QTableWidget* table) const {
   const int r = table->rowCount();
   const int c = table->columnCount();
@@ -198,18 +277,154 @@ Matrix MainWindow::loadMatrixFromTable(QTableWidget* table) const {
 }
 
 void MainWindow::displayMatrixInTable(const Matrix& M, QTableWidget* table) {
+  table->clear();
   table->setRowCount(static_cast<int>(M.rows()));
   table->setColumnCount(static_cast<int>(M.cols()));
+  char buf[Fraction::kMaxChars];
   for (std::size_t i = 0; i < M.rows(); ++i)
     for (std::size_t j = 0; j < M.cols(); ++j) {
-      QTableWidgetItem* item = new QTableWidgetItem(QString::fromStdString(M(i, j).toString()));
+      const char* end = M(i, j).toChars(buf, buf + sizeof(buf));
+      QTableWidgetItem* item = new QTableWidgetItem(QString::fromLatin1(buf, static_cast<int>(end - buf)));
       table->setItem(static_cast<int>(i), static_cast<int>(j), item);
     }
 }
 
 void MainWindow::setResult(const Matrix& M) {
+  lastResult_ = M;
+  if (M.rows() * M.cols() > kMaxDisplayCells) {
+    resultTable_->clear();
+    resultTable_->setRowCount(0);
+    resultTable_->setColumnCount(0);
+    updateDiagnostics();
+    showResultStatus(tr("Result is %1x%2, too large to display. Use Export or Copy.").arg(M.rows()).arg(M.cols()));
+    return;
+  }
   displayMatrixInTable(M, resultTable_);
-  showStatus(tr("Result updated."));
+  updateDiagnostics();
+  showResultStatus(tr("Result updated."));
+}
+
+void MainWindow::setScalarResult(const Fraction& value, const QString& label) {
+  Matrix M(1, 1);
+  M(0, 0) = value;
+  setResult(M);
+  showResultStatus(tr("%1 = %2").arg(label, QString::fromStdString(value.toString())));
+}
+
+// Coefficients are shown highest degree first, one column per power of x.
+void MainWindow::setCharpolyResult(const Matrix& M) {
+  const Polynomial p = M.charpoly();
+  lastResult_ = Matrix(1, p.size());
+  for (std::size_t i = 0; i < p.size(); ++i)
+    lastResult_(0, i) = p[p.size() - 1 - i];
+  resultTable_->clear();
+  resultTable_->setRowCount(1);
+  resultTable_->setColumnCount(static_cast<int>(p.size()));
+  QStringList headers;
+  for (std::size_t i = 0; i < p.size(); ++i) {
+    const std::size_t power = p.size() - 1 - i;
+    headers << (power == 0 ? QStringLiteral("1") : power == 1 ? QStringLiteral("x")
+                                                               : QStringLiteral("x^%1").arg(power));
+    resultTable_->setItem(0, static_cast<int>(i),
+                          new QTableWidgetItem(QString::fromStdString(p[power].toString())));
+  }
+  resultTable_->setHorizontalHeaderLabels(headers);
+  updateDiagnostics();
+  showResultStatus(tr("det(xI − M) = %1").arg(QString::fromStdString(poly::toString(p))));
+}
+
+// Exact rational eigenvalues first, then floating approximations of the remaining roots.
+void MainWindow::setEigenvalueResult(const Matrix& M) {
+  const Eigenvalues ev = M.eigenvalues();
+  lastResult_ = Matrix(ev.exact.size(), 1);  // only the exact eigenvalues are exportable
+  for (std::size_t i = 0; i < ev.exact.size(); ++i)
+    lastResult_(i, 0) = ev.exact[i];
+  resultTable_->clear();
+  resultTable_->setColumnCount(1);
+  resultTable_->setRowCount(static_cast<int>(ev.exact.size() + ev.approximate.size()));
+  resultTable_->setHorizontalHeaderLabels(QStringList() << tr("Eigenvalue"));
+  int row = 0;
+  for (const Fraction& f : ev.exact)
+    resultTable_->setItem(row++, 0, new QTableWidgetItem(QString::fromStdString(f.toString())));
+  for (const std::complex<double>& z : ev.approximate) {
+    const double re = z.real();
+    const double im = std::abs(z.imag()) < 1e-12 * (1.0 + std::abs(re)) ? 0.0 : z.imag();
+    QString text = QStringLiteral("≈ %1").arg(re, 0, 'g', 12);
+    if (im != 0.0)
+      text += (im < 0 ? QStringLiteral(" − %1i") : QStringLiteral(" + %1i")).arg(std::abs(im), 0, 'g', 12);
+    resultTable_->setItem(row++, 0, new QTableWidgetItem(text));
+  }
+  updateDiagnostics();
+  showResultStatus(tr("%1 exact rational eigenvalue(s), %2 approximated.")
+               .arg(ev.exact.size())
+               .arg(ev.approximate.size()));
+}
+
+void MainWindow::exportResult() {
+  QString selectedFilter;
+  const QString path = QFileDialog::getSaveFileName(
+    this, tr("Export result"), QString(),
+    tr("CSV (*.csv);;LaTeX (*.tex);;Binary matrix (*.mtx)"), &selectedFilter);
+  if (path.isEmpty()) return;
+  try {
+    ExportFormat format = exportFormatForPath(path.toStdString());
+    if (QFileInfo(path).suffix().isEmpty())  // no extension typed: go by the chosen filter
+      format = selectedFilter.startsWith(QStringLiteral("CSV")) ? ExportFormat::Csv
+             : selectedFilter.startsWith(QStringLiteral("LaTeX")) ? ExportFormat::Latex
+                                                                 : ExportFormat::Binary;
+    exportMatrixToFile(lastResult_, path.toStdString(), format);
+    showStatus(tr("Exported %1x%2 result to %3.").arg(lastResult_.rows()).arg(lastResult_.cols()).arg(path));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::copyResultCsv() {
+  QApplication::clipboard()->setText(QString::fromStdString(exportMatrixToString(lastResult_, ExportFormat::Csv)));
+  showStatus(tr("Result copied as CSV."));
+}
+
+void MainWindow::copyResultLatex() {
+  QApplication::clipboard()->setText(QString::fromStdString(exportMatrixToString(lastResult_, ExportFormat::Latex)));
+  showStatus(tr("Result copied as LaTeX."));
+}
+
+void MainWindow::updateDiagnostics() {
+  if (!diagnosticsView_) return;
+  if (!instr::enabled()) {
+    diagnosticsView_->setPlainText(tr("Instrumentation is disabled. Reconfigure with "
+                                      "-DMATRIX_INSTRUMENTATION=ON to collect counters."));
+    return;
+  }
+  const instr::Snapshot totals = instr::snapshot();
+  QString text = tr("Totals: %1 fractions, %2 gcd calls, %3 pivot swaps, peak entry %4 bits")
+                   .arg(totals.fractionConstructions)
+                   .arg(totals.gcdCalls)
+                   .arg(totals.pivotSwaps)
+                   .arg(totals.peakEntryBits);
+  const std::string last = instr::summary(instr::lastOperation());
+  if (!last.empty())
+    text += QStringLiteral("\n") + tr("Last: %1").arg(QString::fromStdString(last));
+  diagnosticsView_->setPlainText(text);
+}
+
+void MainWindow::exportDiagnosticsJson() {
+  const QString path = QFileDialog::getSaveFileName(this, tr("Export diagnostics"), QString(),
+                                                    tr("JSON files (*.json)"));
+  if (path.isEmpty()) return;
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    showError(tr("Could not write %1.").arg(path));
+    return;
+  }
+  file.write(QByteArray::fromStdString(instr::toJson()));
+  showStatus(tr("Diagnostics exported to %1.").arg(path));
+}
+
+void MainWindow::resetDiagnostics() {
+  instr::reset();
+  updateDiagnostics();
+  showStatus(tr("Diagnostics counters reset."));
 }
 
 void MainWindow::showError(const QString& message) {
@@ -221,6 +436,11 @@ void MainWindow::showStatus(const QString& message) {
   if (statusBar_) statusBar_->showMessage(message);
 }
 
+void MainWindow::showResultStatus(const QString& message) {
+  const std::string last = instr::summary(instr::lastOperation());
+  showStatus(last.empty() ? message : tr("%1 %2").arg(message, QString::fromStdString(last)));
+}
+
 void MainWindow::performAddition() {
   try {
     Matrix A = loadMatrixFromTable(tableA_);
@@ -311,6 +531,31 @@ void MainWindow::performScalarDivideB() {
   }
 }
 
+// The scalar field doubles as the exponent for A^k / B^k; it must hold an integer.
+std::int64_t MainWindow::exponentFromScalarField() const {
+  const Fraction k = Fraction::fromString(scalarEdit_->text().trimmed().toStdString());
+  if (k.denominator() != 1) throw std::invalid_argument("Matrix power: exponent must be an integer.");
+  return k.numerator();
+}
+
+void MainWindow::performPowerA() {
+  try {
+    Matrix A = loadMatrixFromTable(tableA_);
+    setResult(A.pow(exponentFromScalarField()));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performPowerB() {
+  try {
+    Matrix B = loadMatrixFromTable(tableB_);
+    setResult(B.pow(exponentFromScalarField()));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
 void MainWindow::performRREFOnA() {
   try {
     Matrix A = loadMatrixFromTable(tableA_);
@@ -347,6 +592,111 @@ void MainWindow::performInverseB() {
   }
 }
 
+void MainWindow::performDeterminantA() {
+  try {
+    Matrix A = loadMatrixFromTable(tableA_);
+    setScalarResult(A.determinant(), tr("det(A)"));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performDeterminantB() {
+  try {
+    Matrix B = loadMatrixFromTable(tableB_);
+    setScalarResult(B.determinant(), tr("det(B)"));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performTraceA() {
+  try {
+    Matrix A = loadMatrixFromTable(tableA_);
+    setScalarResult(A.trace(), tr("trace(A)"));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performTraceB() {
+  try {
+    Matrix B = loadMatrixFromTable(tableB_);
+    setScalarResult(B.trace(), tr("trace(B)"));
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performCharpolyA() {
+  try {
+    Matrix A = loadMatrixFromTable(tableA_);
+    setCharpolyResult(A);
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performCharpolyB() {
+  try {
+    Matrix B = loadMatrixFromTable(tableB_);
+    setCharpolyResult(B);
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performEigenvaluesA() {
+  try {
+    Matrix A = loadMatrixFromTable(tableA_);
+    setEigenvalueResult(A);
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performEigenvaluesB() {
+  try {
+    Matrix B = loadMatrixFromTable(tableB_);
+    setEigenvalueResult(B);
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::performExpression() {
+  try {
+    session_.set("A", loadMatrixFromTable(tableA_));
+    session_.set("B", loadMatrixFromTable(tableB_));
+    ExpressionValue value = session_.evaluate(expressionEdit_->text().trimmed().toStdString());
+    if (value.isScalar) {
+      Matrix scalar(1, 1);
+      scalar(0, 0) = value.scalar;
+      setResult(scalar);
+    } else {
+      setResult(value.matrix);
+    }
+    const ExpressionPlan& plan = session_.lastPlan();
+    showResultStatus(tr("Expression evaluated: %1 nodes (%2 shared), %3 scalar multiplies (left-to-right: %4).")
+                 .arg(plan.nodes)
+                 .arg(plan.sharedSubexpressions)
+                 .arg(plan.plannedMultiplies)
+                 .arg(plan.naiveMultiplies));
+    updateSessionNames();
+  } catch (const std::exception& e) {
+    showError(QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::updateSessionNames() {
+  if (!sessionLabel_) return;
+  QStringList names;
+  for (const std::string& name : session_.names())
+    names << QString::fromStdString(name);
+  sessionLabel_->setText(names.isEmpty() ? tr("Session matrices: A, B (from the tables)")
+                                         : tr("Session matrices: %1").arg(names.join(QStringLiteral(", "))));
+}
+
 void MainWindow::runInternalTests() {
   auto run = [this](const char* name, bool ok) {
     if (ok)
@@ -382,6 +732,200 @@ void MainWindow::runInternalTests() {
     I3(1, 0) = Fraction(0, 1); I3(1, 1) = Fraction(1, 1); I3(1, 2) = Fraction(0, 1);
     I3(2, 0) = Fraction(0, 1); I3(2, 1) = Fraction(0, 1); I3(2, 2) = Fraction(1, 1);
     run("A*A.inverse() ≈ I (3x3)", Matrix::approxEqual(CinvC, I3));
+    const Matrix halfC = C / Fraction(2, 1);
+    const PivotPolicy sparse{PivotStrategy::SmallestBitSize, true};
+    const PivotPolicy partial{PivotStrategy::LargestMagnitude, false};
+    run("inverse()/rref() independent of pivot policy",
+        Matrix::approxEqual(C.inverse(sparse), invC) &&
+        Matrix::approxEqual(halfC.inverse(sparse), halfC.inverse(partial)) &&
+        Matrix::approxEqual(halfC.rref(sparse), halfC.rref(partial)));
+    run("Fraction-path inverse() owns dense storage (no n×2n view)", halfC.inverse().isContiguous());
+
+    // A top-level operation's record carries exactly what it added to the totals; toJson() lists it
+    // and reset() clears totals, history and the last record. Without instrumentation all stay empty.
+    instr::reset();
+    (void)halfC.inverse();
+    const instr::OperationRecord op = instr::lastOperation();
+    const instr::Snapshot totals = instr::snapshot();
+    const std::string json = instr::toJson();
+    instr::reset();
+    const instr::Snapshot zeroed = instr::snapshot();
+    const bool cleared = zeroed.fractionConstructions == 0 && zeroed.gcdCalls == 0 && zeroed.peakEntryBits == 0 &&
+                         instr::history().empty() && instr::lastOperation().name.empty();
+    if (instr::enabled())
+      run("instrumentation: inverse record == totals, toJson, reset()",
+          op.name == "inverse" && op.rows == 3 && op.depth == 0 && op.counters.gcdCalls > 0 &&
+          op.counters.fractionConstructions == totals.fractionConstructions &&
+          op.counters.gcdCalls == totals.gcdCalls && op.counters.peakEntryBits == totals.peakEntryBits &&
+          json.find("\"name\":\"inverse\"") != std::string::npos && cleared);
+    else
+      run("instrumentation disabled: no records, zero totals, toJson says so",
+          op.name.empty() && totals.fractionConstructions == 0 &&
+          json.find("\"enabled\":false") != std::string::npos && cleared);
+
+    // Fibonacci: F^k = [[F(k+1), F(k)], [F(k), F(k−1)]]; k = 90 takes the Cayley–Hamilton path.
+    const Matrix F{{1, 1}, {1, 0}};
+    const Matrix F90 = F.pow(90);
+    Matrix Cpow = I3;
+    for (int i = 0; i < 5; ++i) Cpow = Cpow * C;
+    run("pow(): squaring, Cayley–Hamilton, negative and zero exponents",
+        Matrix::approxEqual(C.pow(5), Cpow) && Matrix::approxEqual(halfC.pow(-2), halfC.inverse() * halfC.inverse()) &&
+        Matrix::approxEqual(C.pow(0), I3) && F90(0, 1) == Fraction(2880067194370816120LL) &&
+        Matrix::approxEqual(F.pow(89) * F, F90));
+    // Jordan block: charpoly (x − 1)³, so x^k mod it overflows long before J^k does.
+    const Matrix J{{1, 1, 0}, {0, 1, 1}, {0, 0, 1}};
+    const std::int64_t jk = 3000000000LL;
+    const Matrix Jk{{1, Fraction(jk), Fraction(jk / 2 * (jk - 1))}, {0, 1, Fraction(jk)}, {0, 0, 1}};
+    run("pow(): overflowing Cayley–Hamilton reduction falls back to squaring", Matrix::approxEqual(J.pow(jk), Jk));
+
+    MatrixSession session;
+    session.set("A", A);
+    session.set("B", B);
+    ExpressionValue e = session.evaluate("inv(A)*B*A + 2*B^T - (A+B)*(B+A)");
+    Matrix expected = A.inverse() * B * A + B.transpose() * Fraction(2, 1) - (A + B) * (A + B);
+    run("expression inv(A)*B*A + 2*B^T - (A+B)^2", !e.isScalar && Matrix::approxEqual(e.matrix, expected));
+
+    const Matrix R{{Fraction(-7, 3), 0, Fraction(INT64_MAX)}, {Fraction(1, INT64_MAX), 5, Fraction(-2, 9)}};
+    std::istringstream binary(exportMatrixToString(R, ExportFormat::Binary));
+    const Matrix imported = importMatrixBinary(binary);
+    // Headers claiming 2^32 x 2^32 (rows*cols wraps) and 1000 x 1000 with no entries behind them.
+    std::string wrapped = exportMatrixToString(Matrix(0, 0), ExportFormat::Binary), unbacked = wrapped;
+    wrapped[12] = wrapped[20] = 1;
+    unbacked[9] = unbacked[17] = 3;
+    unbacked[8] = unbacked[16] = static_cast<char>(0xe8);
+    int rejected = 0;
+    for (const std::string& header : {wrapped, unbacked}) {
+      std::istringstream in(header);
+      try {
+        (void)importMatrixBinary(in);
+      } catch (const std::runtime_error&) {
+        ++rejected;
+      }
+    }
+    run("binary export/import round trip; oversized headers rejected",
+        imported.rows() == 2 && imported.cols() == 3 && Matrix::approxEqual(imported, R) && rejected == 2);
+
+    // Lane 1 overflows the int64 Bareiss kernel (2^32 · (2^32 + 2)) and falls back to Fraction; lane 2 is singular.
+    const std::int64_t big = std::int64_t(1) << 32;
+    const std::vector<Matrix> lanes = {
+        Matrix{{2, 1, 0}, {1, 3, 1}, {0, 1, 4}},
+        Matrix{{big, big + 1, 0}, {big, big + 2, 1}, {0, 0, 1}},
+        Matrix{{1, 2, 3}, {2, 4, 6}, {1, 0, 1}},
+        Matrix{{0, 1, 2}, {1, 0, 3}, {4, -3, 8}},
+        Matrix{{Fraction(1, 2), 0, 1}, {0, Fraction(2, 3), 0}, {1, 0, 3}},
+    };
+    const MatrixBatch batch(lanes);
+    const std::vector<Fraction> dets = batch.determinant();
+    const MatrixBatch reduced = batch.rref();
+    bool lanesMatch = dets.size() == lanes.size();
+    for (std::size_t b = 0; b < lanes.size() && lanesMatch; ++b)
+      lanesMatch = dets[b] == lanes[b].determinant() && Matrix::approxEqual(reduced.get(b), lanes[b].rref());
+    std::vector<Matrix> invertible = lanes;
+    invertible.erase(invertible.begin() + 2);
+    const MatrixBatch inverses = MatrixBatch(invertible).inverse();
+    for (std::size_t b = 0; b < invertible.size() && lanesMatch; ++b)
+      lanesMatch = Matrix::approxEqual(inverses.get(b), invertible[b].inverse());
+    run("MatrixBatch det/rref/inverse == Matrix per lane (int64 overflow, zero pivot, rational)",
+        lanesMatch && dets[1] == Fraction(big));
+    bool singularNamed = false;
+    try {
+      (void)batch.inverse();
+    } catch (const std::runtime_error& err) {
+      singularNamed = std::string(err.what()).find("matrix 2 is singular") != std::string::npos;
+    }
+    run("MatrixBatch inverse names the singular lane", singularNamed);
+
+    const std::string tmp = std::filesystem::temp_directory_path().string();
+    const std::string pathTA = tmp + "/matrix_selftest_a.mtxt", pathTB = tmp + "/matrix_selftest_b.mtxt";
+    const std::string pathTC = tmp + "/matrix_selftest_c.mtxt";
+    const std::size_t tile = 4, minBudget = TiledMatrix::kMinCachedTiles * tile * tile * sizeof(Fraction);
+    // 7x10 in 4x4 tiles (3-row and 2-column edge tiles), rank 5 with pivots in columns 0, 1, 5, 6, 9:
+    // the third pivot lies one tile column to the right of its row's tile. Mixed by the unimodular
+    // min(i, j) + 1 matrix with its rows reversed, so rref() must recover the echelon form exactly.
+    Matrix echelon(7, 10);
+    const std::size_t lead[5] = {0, 1, 5, 6, 9};
+    for (std::size_t i = 0; i < 5; ++i) {
+      echelon(i, lead[i]) = Fraction(1);
+      for (std::size_t j = lead[i] + 1; j < 10; ++j)
+        if (j != 1 && j != 5 && j != 6 && j != 9)
+          echelon(i, j) = Fraction(static_cast<std::int64_t>((i + 2 * j) % 5) - 2);
+    }
+    Matrix mix(7, 7);
+    for (std::size_t i = 0; i < 7; ++i)
+      for (std::size_t j = 0; j < 7; ++j) mix(6 - i, j) = Fraction(static_cast<std::int64_t>(std::min(i, j) + 1));
+    const Matrix mixed = mix * echelon;
+    std::size_t tiledRank = 0;
+    bool tiledRrefMatches = false;
+    {
+      TiledMatrix tiled = TiledMatrix::fromMatrix(mixed, pathTA, tile, minBudget);
+      tiledRank = tiled.rrefInPlace();
+      tiledRrefMatches = Matrix::approxEqual(tiled.toMatrix(), mixed.rref()) && Matrix::approxEqual(mixed.rref(), echelon);
+    }
+    run("TiledMatrix rrefInPlace == Matrix::rref (edge tiles, pivot across tile columns, rank 5)",
+        tiledRank == 5 && tiledRrefMatches);
+    // The product is written by one TiledMatrix and read back through open().
+    const Matrix right = echelon.transpose() * Fraction(1, 3);
+    {
+      TiledMatrix ta = TiledMatrix::fromMatrix(mixed, pathTA, tile, minBudget);
+      TiledMatrix tb = TiledMatrix::fromMatrix(right, pathTB, tile, minBudget);
+      (void)ta.multiply(tb, pathTC, minBudget);
+    }
+    run("TiledMatrix multiply round trip through open()",
+        Matrix::approxEqual(TiledMatrix::open(pathTC, minBudget).toMatrix(), mixed * right));
+    std::string tileFile;
+    {
+      std::ifstream in(pathTC, std::ios::binary);
+      tileFile.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string truncated = tileFile.substr(0, tileFile.size() - 1), badMagic = tileFile;
+    badMagic[3] = 'Q';
+    int refused = 0;
+    for (const std::string& contents : {truncated, badMagic}) {
+      std::ofstream(pathTB, std::ios::binary | std::ios::trunc) << contents;
+      try {
+        (void)TiledMatrix::open(pathTB, minBudget);
+      } catch (const std::runtime_error&) {
+        ++refused;
+      }
+    }
+    run("TiledMatrix open() rejects a truncated file and a bad magic header", refused == 2);
+    std::remove(pathTB.c_str());
+    bool budgetRefused = false;
+    try {
+      (void)TiledMatrix::create(pathTB, 7, 10, tile, minBudget - 1);
+    } catch (const std::invalid_argument&) {
+      budgetRefused = !std::filesystem::exists(pathTB);
+    }
+    run("TiledMatrix refuses a budget below kMinCachedTiles before creating the file", budgetRefused);
+    for (const std::string& path : {pathTA, pathTB, pathTC}) std::remove(path.c_str());
+
+    const Polynomial berkowitz = C.charpoly(CharpolyMethod::Berkowitz);
+    const Polynomial hessenberg = C.charpoly(CharpolyMethod::Hessenberg);
+    run("charpoly Berkowitz == Hessenberg (3x3)", berkowitz == hessenberg);
+    run("charpoly constant term == -det (3x3)", berkowitz[0] == -C.determinant());
+    Matrix G(7, 7);  // dense one-digit entries: a Fraction Hessenberg reduction would overflow int64
+    for (std::size_t i = 0; i < 7; ++i)
+      for (std::size_t j = 0; j < 7; ++j)
+        G(i, j) = Fraction(static_cast<std::int64_t>((i * 7 + j * 5 + i * j) % 19) - 9, 1);
+    run("charpoly Hessenberg (mod p) == Berkowitz (7x7)",
+        G.charpoly(CharpolyMethod::Hessenberg) == G.charpoly(CharpolyMethod::Berkowitz) &&
+        G.charpoly()[0] == Fraction(-34665386));
+    // Entries in [−2, 2]: Berkowitz's intermediate products leave int64, the coefficients (< 2^49) do not.
+    std::mt19937 rng(1);
+    Matrix W(24, 24);
+    for (std::size_t i = 0; i < 24; ++i)
+      for (std::size_t j = 0; j < 24; ++j) W(i, j) = Fraction(static_cast<std::int64_t>(rng() % 5) - 2, 1);
+    const Polynomial pw = W.charpoly();
+    run("charpoly (24x24) where Berkowitz overflows",
+        pw.size() == 25 && pw[24] == Fraction(1) && pw[23] == -W.trace() && pw[0] == Fraction(-317147929708689));
+    const Eigenvalues ev = C.eigenvalues();
+    run("eigenvalues of C: 2 exact, (3±√5)/2 approximated",
+        ev.exact.size() == 1 && ev.exact[0] == Fraction(2, 1) && ev.approximate.size() == 2);
+    // x^4 − 999999: the candidate root 999999 overflows when evaluated, so it is simply not a root.
+    const Matrix companion{{0, 0, 0, 999999}, {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}};
+    const Eigenvalues evc = companion.eigenvalues();
+    run("eigenvalues skip candidates that overflow (x^4 - 999999)",
+        evc.exact.empty() && evc.approximate.size() == 4);
   } catch (const std::exception& e) {
     qDebug("Matrix internal test exception: %s", e.what());
   }
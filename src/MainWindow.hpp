@@ -3,11 +3,13 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include "expression.hpp"
 #include "matrix.hpp"
 #include <QMainWindow>
 #include <QTableWidget>
 
 class QLineEdit;
+class QPlainTextEdit;
 class QSpinBox;
 class QGroupBox;
 class QLabel;
@@ -37,23 +39,47 @@ private slots:
   void performScalarMultiplyB();
   void performScalarDivideA();
   void performScalarDivideB();
+  void performPowerA();
+  void performPowerB();
   void performRREFOnA();
   void performRREFOnB();
   void performInverseA();
   void performInverseB();
+  void performDeterminantA();
+  void performDeterminantB();
+  void performTraceA();
+  void performTraceB();
+  void performCharpolyA();
+  void performCharpolyB();
+  void performEigenvaluesA();
+  void performEigenvaluesB();
+  void performExpression();
+  void exportResult();
+  void copyResultCsv();
+  void copyResultLatex();
+  void exportDiagnosticsJson();
+  void resetDiagnostics();
 
 private:
   void setupUi();
   void buildMatrixInputs();
   void buildOperationPanel();
   void buildResultView();
+  void buildDiagnosticsPanel();
   void runInternalTests();
 
   Matrix loadMatrixFromTable(QTableWidget* table) const;
+  std::int64_t exponentFromScalarField() const;
   void displayMatrixInTable(const Matrix& M, QTableWidget* table);
   void setResult(const Matrix& M);
+  void setScalarResult(const Fraction& value, const QString& label);
+  void setCharpolyResult(const Matrix& M);
+  void setEigenvalueResult(const Matrix& M);
   void showError(const QString& message);
   void showStatus(const QString& message);
+  void showResultStatus(const QString& message);  // message plus the last operation's counters, if any
+  void updateDiagnostics();
+  void updateSessionNames();
 
   QSpinBox* rowsA_;
   QSpinBox* colsA_;
@@ -63,8 +89,13 @@ private:
   QTableWidget* tableB_;
   QTableWidget* resultTable_;
   QLineEdit* scalarEdit_;
+  QLineEdit* expressionEdit_;
+  QLabel* sessionLabel_;
+  QPlainTextEdit* diagnosticsView_;
   QStatusBar* statusBar_;
   QWidget* centralWidget_;
+  MatrixSession session_;  // named matrices for the expression input; A and B mirror the tables
+  Matrix lastResult_;      // what Export/Copy write; shares storage with the displayed result
 };
 
 #endif // MAINWINDOW_HPP
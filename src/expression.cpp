@@ -0,0 +1,577 @@
+// expression.cpp — Expression tokenizer, DAG builder (CSE + matrix-chain ordering) and level-parallel evaluator.
+
+#include "expression.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+  enum class Op { Name, Literal, Add, Sub, Neg, Mul, Div, Scale, Transpose, Inverse, Rref, Pow, Det, Trace };
+
+  struct Node {
+    Op op = Op::Literal;
+    int a = -1;
+    int b = -1;
+    std::int64_t k = 0;  // exponent for Op::Pow
+    Fraction literal;
+    std::string name;
+    bool isScalar = false;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    int level = 0;       // 0 for leaves, else 1 + max(level of children)
+  };
+
+  struct Token {
+    enum Kind { Number, Ident, Symbol, End } kind;
+    std::string text;
+    std::size_t pos;
+  };
+
+  bool isReserved(const std::string& s) {
+    return s == "inv" || s == "rref" || s == "transpose" || s == "det" || s == "trace" || s == "T";
+  }
+
+  [[noreturn]] void syntaxError(const std::string& what, std::size_t pos) {
+    std::ostringstream oss;
+    oss << "Expression: " << what << " at position " << pos + 1 << ".";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::vector<Token> tokenize(const std::string& s) {
+    std::vector<Token> tokens;
+    std::size_t i = 0;
+    while (i < s.size()) {
+      const unsigned char c = static_cast<unsigned char>(s[i]);
+      if (std::isspace(c)) {
+        ++i;
+      } else if (std::isdigit(c) || (c == '.' && i + 1 < s.size() && std::isdigit(static_cast<unsigned char>(s[i + 1])))) {
+        std::size_t start = i;
+        while (i < s.size() && (std::isdigit(static_cast<unsigned char>(s[i])) || s[i] == '.')) ++i;
+        tokens.push_back({Token::Number, s.substr(start, i - start), start});
+      } else if (std::isalpha(c) || c == '_') {
+        std::size_t start = i;
+        while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) || s[i] == '_')) ++i;
+        tokens.push_back({Token::Ident, s.substr(start, i - start), start});
+      } else if (std::string("+-*/^()=").find(static_cast<char>(c)) != std::string::npos) {
+        tokens.push_back({Token::Symbol, std::string(1, static_cast<char>(c)), i});
+        ++i;
+      } else {
+        syntaxError(std::string("unexpected character '") + static_cast<char>(c) + "'", i);
+      }
+    }
+    tokens.push_back({Token::End, std::string(), s.size()});
+    return tokens;
+  }
+
+  // Recursive-descent parser that builds a hash-consed DAG of shape-checked nodes.
+  class Builder {
+  public:
+    Builder(const std::vector<Token>& tokens, std::size_t start,
+            const std::map<std::string, Matrix>& env, ExpressionPlan& plan)
+      : tokens_(tokens), pos_(start), env_(env), plan_(plan) {}
+
+    std::vector<Node> nodes;
+
+    int parse() {
+      int root = expr();
+      if (peek().kind != Token::End) syntaxError("unexpected '" + peek().text + "'", peek().pos);
+      return root;
+    }
+
+  private:
+    const std::vector<Token>& tokens_;
+    std::size_t pos_;
+    const std::map<std::string, Matrix>& env_;
+    ExpressionPlan& plan_;
+    std::map<std::string, int> interned_;
+
+    const Token& peek() const { return tokens_[pos_]; }
+    bool accept(const char* sym) {
+      if (peek().kind == Token::Symbol && peek().text == sym) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+    void expect(const char* sym) {
+      if (!accept(sym)) syntaxError(std::string("expected '") + sym + "'", peek().pos);
+    }
+
+    int intern(Node n) {
+      std::ostringstream key;
+      key << static_cast<int>(n.op) << ':' << n.a << ',' << n.b << ':' << n.k << ':'
+          << n.literal.toString() << ':' << n.name;
+      auto it = interned_.find(key.str());
+      if (it != interned_.end()) {
+        ++plan_.sharedSubexpressions;
+        return it->second;
+      }
+      if (n.a >= 0) n.level = std::max(n.level, nodes[n.a].level + 1);
+      if (n.b >= 0) n.level = std::max(n.level, nodes[n.b].level + 1);
+      nodes.push_back(std::move(n));
+      int id = static_cast<int>(nodes.size()) - 1;
+      interned_.emplace(key.str(), id);
+      return id;
+    }
+
+    int scalarNode(Op op, int a, int b = -1) {
+      Node n;
+      n.op = op;
+      n.a = a;
+      n.b = b;
+      n.isScalar = true;
+      return intern(n);
+    }
+
+    int matrixNode(Op op, int a, int b, std::size_t rows, std::size_t cols, std::int64_t k = 0) {
+      Node n;
+      n.op = op;
+      n.a = a;
+      n.b = b;
+      n.k = k;
+      n.rows = rows;
+      n.cols = cols;
+      return intern(n);
+    }
+
+    int literal(const Fraction& f) {
+      Node n;
+      n.op = Op::Literal;
+      n.literal = f;
+      n.isScalar = true;
+      return intern(n);
+    }
+
+    int reciprocal(int a) { return scalarNode(Op::Div, literal(Fraction(1, 1)), a); }
+
+    int addOrSub(int a, int b, bool subtract, std::size_t pos) {
+      const Node& x = nodes[a];
+      const Node& y = nodes[b];
+      if (x.isScalar != y.isScalar)
+        syntaxError("cannot add a scalar and a matrix", pos);
+      if (!x.isScalar && (x.rows != y.rows || x.cols != y.cols)) {
+        std::ostringstream oss;
+        oss << "dimension mismatch (" << x.rows << "x" << x.cols << ") "
+            << (subtract ? '-' : '+') << " (" << y.rows << "x" << y.cols << ")";
+        syntaxError(oss.str(), pos);
+      }
+      // Addition commutes; order operands so A+B and B+A share one node.
+      if (!subtract && a > b) std::swap(a, b);
+      const Op op = subtract ? Op::Sub : Op::Add;
+      return x.isScalar ? scalarNode(op, a, b) : matrixNode(op, a, b, x.rows, x.cols);
+    }
+
+    int negate(int a) {
+      const Node& x = nodes[a];
+      return x.isScalar ? scalarNode(Op::Neg, a) : matrixNode(Op::Neg, a, -1, x.rows, x.cols);
+    }
+
+    int transpose(int a) {
+      const Node& x = nodes[a];
+      return x.isScalar ? a : matrixNode(Op::Transpose, a, -1, x.cols, x.rows);
+    }
+
+    int invert(int a, std::size_t pos) {
+      const Node& x = nodes[a];
+      if (x.isScalar) return reciprocal(a);
+      if (x.rows != x.cols) syntaxError("inverse of a non-square matrix", pos);
+      return matrixNode(Op::Inverse, a, -1, x.rows, x.cols);
+    }
+
+    int power(int a, std::int64_t k, std::size_t pos) {
+      const Node& x = nodes[a];
+      if (x.isScalar) syntaxError("scalar powers are not supported", pos);
+      if (x.rows != x.cols) syntaxError("power of a non-square matrix", pos);
+      const std::size_t n = x.rows;
+      if (k == 1) return a;
+      if (k < 0) {
+        int inv = invert(a, pos);
+        return matrixNode(Op::Pow, inv, -1, n, n, -k);
+      }
+      return matrixNode(Op::Pow, a, -1, n, n, k);
+    }
+
+    // Optimal parenthesization of mats[0] * ... * mats[n-1] by the classic O(n³) DP.
+    int chainProduct(const std::vector<int>& mats, const std::vector<std::size_t>& positions) {
+      const std::size_t n = mats.size();
+      std::vector<std::uint64_t> dims(n + 1);
+      dims[0] = nodes[mats[0]].rows;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (nodes[mats[i]].rows != dims[i]) {
+          std::ostringstream oss;
+          oss << "dimension mismatch (" << nodes[mats[i - 1]].rows << "x" << dims[i] << ") * ("
+              << nodes[mats[i]].rows << "x" << nodes[mats[i]].cols << ")";
+          syntaxError(oss.str(), positions[i]);
+        }
+        dims[i + 1] = nodes[mats[i]].cols;
+      }
+      for (std::size_t i = 1; i < n; ++i)
+        plan_.naiveMultiplies += dims[0] * dims[i] * dims[i + 1];
+
+      std::vector<std::vector<std::uint64_t>> cost(n, std::vector<std::uint64_t>(n, 0));
+      std::vector<std::vector<std::size_t>> split(n, std::vector<std::size_t>(n, 0));
+      for (std::size_t len = 2; len <= n; ++len)
+        for (std::size_t i = 0; i + len <= n; ++i) {
+          const std::size_t j = i + len - 1;
+          cost[i][j] = std::numeric_limits<std::uint64_t>::max();
+          for (std::size_t s = i; s < j; ++s) {
+            std::uint64_t c = cost[i][s] + cost[s + 1][j] + dims[i] * dims[s + 1] * dims[j + 1];
+            if (c < cost[i][j]) {
+              cost[i][j] = c;
+              split[i][j] = s;
+            }
+          }
+        }
+      plan_.plannedMultiplies += cost[0][n - 1];
+      return buildChain(mats, split, 0, n - 1);
+    }
+
+    int buildChain(const std::vector<int>& mats, const std::vector<std::vector<std::size_t>>& split,
+                   std::size_t i, std::size_t j) {
+      if (i == j) return mats[i];
+      const std::size_t s = split[i][j];
+      int left = buildChain(mats, split, i, s);
+      int right = buildChain(mats, split, s + 1, j);
+      return matrixNode(Op::Mul, left, right, nodes[left].rows, nodes[right].cols);
+    }
+
+    int expr() {
+      int lhs = term();
+      for (;;) {
+        const std::size_t pos = peek().pos;
+        if (accept("+"))
+          lhs = addOrSub(lhs, term(), false, pos);
+        else if (accept("-"))
+          lhs = addOrSub(lhs, term(), true, pos);
+        else
+          return lhs;
+      }
+    }
+
+    // A term is a product: scalar factors fold into one coefficient, matrix factors form a chain.
+    int term() {
+      std::vector<int> mats;
+      std::vector<std::size_t> positions;
+      int coefficient = -1;
+      auto addFactor = [&](int f, std::size_t pos) {
+        if (nodes[f].isScalar)
+          coefficient = coefficient < 0 ? f : scalarNode(Op::Mul, coefficient, f);
+        else {
+          mats.push_back(f);
+          positions.push_back(pos);
+        }
+      };
+      addFactor(unary(), peek().pos);
+      for (;;) {
+        const std::size_t pos = peek().pos;
+        if (accept("*")) {
+          addFactor(unary(), pos);
+        } else if (accept("/")) {
+          int d = unary();
+          if (!nodes[d].isScalar) syntaxError("division by a matrix (use inv())", pos);
+          addFactor(reciprocal(d), pos);
+        } else {
+          break;
+        }
+      }
+      if (mats.empty()) return coefficient;
+      int product = chainProduct(mats, positions);
+      if (coefficient < 0) return product;
+      return matrixNode(Op::Scale, coefficient, product, nodes[product].rows, nodes[product].cols);
+    }
+
+    int unary() {
+      if (accept("-")) return negate(unary());
+      if (accept("+")) return unary();
+      return postfix();
+    }
+
+    int postfix() {
+      int base = primary();
+      for (;;) {
+        const std::size_t pos = peek().pos;
+        if (!accept("^")) return base;
+        if (peek().kind == Token::Ident && peek().text == "T") {
+          ++pos_;
+          base = transpose(base);
+          continue;
+        }
+        const bool negative = accept("-");
+        if (peek().kind != Token::Number || peek().text.find('.') != std::string::npos)
+          syntaxError("expected 'T' or an integer exponent after '^'", peek().pos);
+        std::int64_t k = 0;
+        try {
+          k = std::stoll(peek().text);
+        } catch (...) {
+          syntaxError("exponent out of range", peek().pos);
+        }
+        ++pos_;
+        if (k == 0 && !nodes[base].isScalar && nodes[base].rows == nodes[base].cols)
+          base = matrixNode(Op::Pow, base, -1, nodes[base].rows, nodes[base].cols, 0);
+        else if (negative && k == 1)
+          base = invert(base, pos);
+        else
+          base = power(base, negative ? -k : k, pos);
+      }
+    }
+
+    int primary() {
+      const Token tok = peek();
+      if (tok.kind == Token::Number) {
+        ++pos_;
+        return literal(Fraction::fromString(tok.text));
+      }
+      if (accept("(")) {
+        int inner = expr();
+        expect(")");
+        return inner;
+      }
+      if (tok.kind != Token::Ident) syntaxError("expected a number, name or '('", tok.pos);
+      ++pos_;
+      if (isReserved(tok.text) && tok.text != "T") {
+        expect("(");
+        int arg = expr();
+        expect(")");
+        if (tok.text == "inv") return invert(arg, tok.pos);
+        if (tok.text == "transpose") return transpose(arg);
+        if (nodes[arg].isScalar) syntaxError(tok.text + " of a scalar", tok.pos);
+        if (tok.text == "rref") return matrixNode(Op::Rref, arg, -1, nodes[arg].rows, nodes[arg].cols);
+        if (nodes[arg].rows != nodes[arg].cols) syntaxError(tok.text + " of a non-square matrix", tok.pos);
+        return scalarNode(tok.text == "det" ? Op::Det : Op::Trace, arg);
+      }
+      auto it = env_.find(tok.text);
+      if (it == env_.end()) syntaxError("unknown matrix '" + tok.text + "'", tok.pos);
+      Node n;
+      n.op = Op::Name;
+      n.name = tok.text;
+      n.rows = it->second.rows();
+      n.cols = it->second.cols();
+      return intern(n);
+    }
+  };
+
+  std::atomic<unsigned> gThreadCount{0};
+
+  // Helper threads shared by every MatrixSession. One DAG level's heavy nodes form a Group; the
+  // evaluating thread and at most `helpers` pool threads claim its tasks one at a time. The caller
+  // keeps claiming until none are left, so a level finishes even when every helper is busy
+  // elsewhere, and the pool never grows past the largest helper count asked for.
+  class NodePool {
+  public:
+    ~NodePool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_all();
+      for (std::thread& t : threads_) t.join();
+    }
+
+    // Runs every task (each must not throw) and returns when all have finished.
+    void run(const std::vector<std::function<void()>>& tasks, unsigned helpers) {
+      Group group{tasks, helpers};
+      if (helpers > 0 && tasks.size() > 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (threads_.size() < helpers) threads_.emplace_back([this] { work(); });
+        queue_.push_back(&group);
+        wake_.notify_all();
+      }
+      claim(group);
+      std::unique_lock<std::mutex> lock(mutex_);
+      queue_.erase(std::remove(queue_.begin(), queue_.end(), &group), queue_.end());
+      finished_.wait(lock, [&] { return group.running == 0; });
+    }
+
+  private:
+    struct Group {
+      const std::vector<std::function<void()>>& tasks;
+      unsigned helpers;
+      std::atomic<std::size_t> next{0};
+      unsigned joined = 0;   // helpers that have taken part (guarded by mutex_)
+      unsigned running = 0;  // helpers still inside claim() (guarded by mutex_)
+    };
+
+    static void claim(Group& group) {
+      for (std::size_t i = group.next.fetch_add(1); i < group.tasks.size(); i = group.next.fetch_add(1))
+        group.tasks[i]();
+    }
+
+    Group* pick() {
+      for (Group* g : queue_)
+        if (g->joined < g->helpers && g->next.load() < g->tasks.size()) return g;
+      return nullptr;
+    }
+
+    void work() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      for (;;) {
+        Group* group = nullptr;
+        wake_.wait(lock, [&] { return stop_ || (group = pick()) != nullptr; });
+        if (stop_) return;
+        ++group->joined;
+        ++group->running;
+        lock.unlock();
+        claim(*group);
+        lock.lock();
+        if (--group->running == 0) finished_.notify_all();
+      }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;      // a group was queued, or stop_
+    std::condition_variable finished_;  // a group's running count reached zero
+    std::vector<Group*> queue_;
+    std::vector<std::thread> threads_;
+    bool stop_ = false;
+  };
+
+  NodePool& nodePool() {
+    static NodePool pool;
+    return pool;
+  }
+
+  ExpressionValue scalarValue(const Fraction& f) {
+    ExpressionValue v;
+    v.isScalar = true;
+    v.scalar = f;
+    return v;
+  }
+
+  ExpressionValue matrixValue(Matrix m) {
+    ExpressionValue v;
+    v.matrix = std::move(m);
+    return v;
+  }
+
+  ExpressionValue evalNode(const Node& n, const std::vector<ExpressionValue>& values,
+                           const std::map<std::string, Matrix>& env) {
+    const ExpressionValue* a = n.a >= 0 ? &values[n.a] : nullptr;
+    const ExpressionValue* b = n.b >= 0 ? &values[n.b] : nullptr;
+    switch (n.op) {
+      case Op::Name: return matrixValue(env.at(n.name));
+      case Op::Literal: return scalarValue(n.literal);
+      case Op::Add: return n.isScalar ? scalarValue(a->scalar + b->scalar) : matrixValue(a->matrix + b->matrix);
+      case Op::Sub: return n.isScalar ? scalarValue(a->scalar - b->scalar) : matrixValue(a->matrix - b->matrix);
+      case Op::Neg: return n.isScalar ? scalarValue(-a->scalar) : matrixValue(a->matrix * Fraction(-1, 1));
+      case Op::Mul: return n.isScalar ? scalarValue(a->scalar * b->scalar) : matrixValue(a->matrix * b->matrix);
+      case Op::Div: return scalarValue(a->scalar / b->scalar);
+      case Op::Scale: return matrixValue(b->matrix * a->scalar);
+      case Op::Transpose: return matrixValue(a->matrix.transpose());
+      case Op::Inverse: return matrixValue(a->matrix.inverse());
+      case Op::Rref: return matrixValue(a->matrix.rref());
+      case Op::Det: return scalarValue(a->matrix.determinant());
+      case Op::Trace: return scalarValue(a->matrix.trace());
+      case Op::Pow: return matrixValue(a->matrix.pow(n.k));
+    }
+    throw std::logic_error("Expression: unknown node kind.");
+  }
+}
+
+void MatrixSession::set(const std::string& name, const Matrix& m) {
+  if (!isValidName(name)) throw std::invalid_argument("Expression: invalid matrix name '" + name + "'.");
+  auto it = matrices_.find(name);
+  if (it != matrices_.end())
+    it->second = m;
+  else
+    matrices_.emplace(name, m);
+}
+
+const Matrix& MatrixSession::get(const std::string& name) const {
+  auto it = matrices_.find(name);
+  if (it == matrices_.end()) throw std::invalid_argument("Expression: unknown matrix '" + name + "'.");
+  return it->second;
+}
+
+std::vector<std::string> MatrixSession::names() const {
+  std::vector<std::string> result;
+  for (const auto& entry : matrices_) result.push_back(entry.first);
+  return result;
+}
+
+void MatrixSession::setThreadCount(unsigned threads) {
+  gThreadCount.store(threads, std::memory_order_relaxed);
+}
+
+bool MatrixSession::isValidName(const std::string& name) {
+  if (name.empty() || isReserved(name)) return false;
+  if (!std::isalpha(static_cast<unsigned char>(name[0])) && name[0] != '_') return false;
+  for (char c : name)
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  return true;
+}
+
+ExpressionValue MatrixSession::evaluate(const std::string& statement) {
+  std::vector<Token> tokens = tokenize(statement);
+  std::size_t start = 0;
+  std::string target;
+  if (tokens.size() > 2 && tokens[0].kind == Token::Ident && tokens[1].kind == Token::Symbol &&
+      tokens[1].text == "=") {
+    target = tokens[0].text;
+    if (!isValidName(target)) syntaxError("cannot assign to '" + target + "'", tokens[0].pos);
+    start = 2;
+  }
+  if (tokens[start].kind == Token::End) syntaxError("empty expression", tokens[start].pos);
+
+  ExpressionPlan plan;
+  Builder builder(tokens, start, matrices_, plan);
+  const int root = builder.parse();
+  const std::vector<Node>& nodes = builder.nodes;
+  plan.nodes = nodes.size();
+  MATRIX_INSTR_SCOPE("expression", nodes[root].rows, nodes[root].cols);
+
+  // Nodes on one level depend only on lower levels, so each level's matrix work can run concurrently.
+  std::vector<ExpressionValue> values(nodes.size());
+  unsigned threads = gThreadCount.load(std::memory_order_relaxed);
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  const int maxLevel = nodes[root].level;
+  for (int level = 0; level <= maxLevel; ++level) {
+    std::vector<int> heavy;
+    for (std::size_t id = 0; id < nodes.size(); ++id) {
+      const Node& n = nodes[id];
+      if (n.level != level) continue;
+      if ((n.isScalar && n.op != Op::Det) || n.op == Op::Name)
+        values[id] = evalNode(n, values, matrices_);
+      else
+        heavy.push_back(static_cast<int>(id));
+    }
+    if (heavy.empty()) continue;
+    const unsigned helpers = static_cast<unsigned>(std::min<std::size_t>(threads - 1, heavy.size() - 1));
+    if (helpers > 0) ++plan.parallelLevels;
+    std::vector<std::exception_ptr> errors(heavy.size());
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(heavy.size());
+    for (std::size_t i = 0; i < heavy.size(); ++i)
+      tasks.push_back([&, i] {
+        try {
+          values[heavy[i]] = evalNode(nodes[heavy[i]], values, matrices_);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    nodePool().run(tasks, helpers);
+    for (const std::exception_ptr& e : errors)
+      if (e) std::rethrow_exception(e);
+  }
+
+  lastPlan_ = plan;
+  ExpressionValue result = values[root];
+  if (result.isScalar) {
+    if (!target.empty())
+      throw std::invalid_argument("Expression: cannot assign a scalar to '" + target + "'.");
+    return result;
+  }
+  set("ans", result.matrix);
+  if (!target.empty()) set(target, result.matrix);
+  return result;
+}
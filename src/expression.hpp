@@ -0,0 +1,67 @@
+// expression.hpp — Matrix expression language over named session matrices.
+// Expressions such as "inv(A)*B*A + 2*B^T" are parsed into a DAG with common-subexpression
+// elimination; multiplication chains are reordered by matrix-chain DP to minimize scalar
+// multiplies, and independent subtrees are evaluated concurrently.
+//
+// Grammar:
+//   statement := [name '='] expr
+//   expr      := term (('+' | '-') term)*
+//   term      := unary (('*' | '/') unary)*          ('/' only by a scalar)
+//   unary     := '-' unary | postfix
+//   postfix   := primary ('^' ('T' | ['-'] integer))*
+//   primary   := number | name | func '(' expr ')' | '(' expr ')'
+//   func      := inv | rref | transpose | det | trace   (det and trace yield scalars)
+
+#ifndef EXPRESSION_HPP
+#define EXPRESSION_HPP
+
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Result of evaluating an expression: either a scalar or a matrix.
+struct ExpressionValue {
+  bool isScalar = false;
+  Fraction scalar;
+  Matrix matrix{0, 0};
+};
+
+// What the planner did with the last expression (for the status bar and benchmarks).
+struct ExpressionPlan {
+  std::size_t nodes = 0;              // DAG nodes after CSE
+  std::size_t sharedSubexpressions = 0;
+  std::uint64_t naiveMultiplies = 0;  // scalar multiplies for left-to-right chain evaluation
+  std::uint64_t plannedMultiplies = 0;
+  std::size_t parallelLevels = 0;     // DAG levels whose nodes were offered to helper threads
+};
+
+class MatrixSession {
+public:
+  void set(const std::string& name, const Matrix& m);
+  bool has(const std::string& name) const { return matrices_.count(name) != 0; }
+  const Matrix& get(const std::string& name) const;
+  void erase(const std::string& name) { matrices_.erase(name); }
+  std::vector<std::string> names() const;
+
+  // Evaluates "expr" or "name = expr". Matrix results are also stored as "ans" (and as name when
+  // assigning). Throws std::invalid_argument for syntax/shape errors, and whatever the Matrix
+  // operations throw (e.g. std::runtime_error for a singular inverse).
+  ExpressionValue evaluate(const std::string& statement);
+  const ExpressionPlan& lastPlan() const { return lastPlan_; }
+
+  static bool isValidName(const std::string& name);
+  // Threads that evaluate the independent nodes of a DAG level, counting the caller; the helpers
+  // come from one pool shared by every session. 0 (default) means std::thread::hardware_concurrency(),
+  // 1 evaluates every node on the calling thread.
+  static void setThreadCount(unsigned threads);
+
+private:
+  std::map<std::string, Matrix> matrices_;
+  ExpressionPlan lastPlan_;
+};
+
+#endif // EXPRESSION_HPP
@@ -1,11 +1,40 @@
 // fraction.cpp — Fraction implementation: normalize, arithmetic, parse, format.
 
 #include "fraction.hpp"
+#include "instrumentation.hpp"
+#include <charconv>
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
 
+namespace {
+  // Slow path for when an int64 cross product overflows: reduce in 128 bits first, so a result
+  // whose lowest terms fit (e.g. a/b + c/b with b near 2^40) is still exact. One that does not
+  // fit throws; INT64_MIN is excluded too, so negating a Fraction never overflows.
+  Fraction fromWide(__int128 num, __int128 den) {
+    if (den < 0) {
+      num = -num;
+      den = -den;
+    }
+    unsigned __int128 a = num < 0 ? -static_cast<unsigned __int128>(num) : static_cast<unsigned __int128>(num);
+    unsigned __int128 b = static_cast<unsigned __int128>(den);
+    while (b != 0) {
+      unsigned __int128 t = a % b;
+      a = b;
+      b = t;
+    }
+    if (a > 1) {
+      num /= static_cast<__int128>(a);
+      den /= static_cast<__int128>(a);
+    }
+    if (num < -INT64_MAX || num > INT64_MAX || den > INT64_MAX)
+      throw std::overflow_error("Fraction: result does not fit in 64 bits.");
+    return Fraction(static_cast<std::int64_t>(num), static_cast<std::int64_t>(den));
+  }
+}
+
 std::int64_t Fraction::gcd(std::int64_t a, std::int64_t b) {
+  MATRIX_INSTR_COUNT(gcdCalls);
   a = std::abs(a);
   b = std::abs(b);
   while (b != 0) {
@@ -19,40 +48,67 @@ std::int64_t Fraction::gcd(std::int64_t a, std::int64_t b) {
 void Fraction::normalize() {
   if (denom_ == 0)
     throw std::invalid_argument("Fraction: denominator is zero.");
+  if (num_ == INT64_MIN || denom_ == INT64_MIN) {
+    *this = fromWide(num_, denom_);
+    return;
+  }
   if (denom_ < 0) {
     num_ = -num_;
     denom_ = -denom_;
   }
-  std::int64_t g = gcd(num_, denom_);
-  if (g != 0) {
-    num_ /= g;
-    denom_ /= g;
+  // Integers (denominator 1) are already in lowest terms.
+  if (denom_ != 1) {
+    std::int64_t g = gcd(num_, denom_);
+    if (g != 0) {
+      num_ /= g;
+      denom_ /= g;
+    }
   }
+  MATRIX_INSTR_ENTRY_BITS(num_, denom_);
 }
 
-Fraction::Fraction() : num_(0), denom_(1) {}
+Fraction::Fraction() : num_(0), denom_(1) {
+  MATRIX_INSTR_COUNT(fractionConstructions);
+}
 
 Fraction::Fraction(std::int64_t numerator, std::int64_t denominator)
   : num_(numerator), denom_(denominator) {
+  MATRIX_INSTR_COUNT(fractionConstructions);
   normalize();
 }
 
 Fraction Fraction::operator+(const Fraction& other) const {
-  return Fraction(num_ * other.denom_ + other.num_ * denom_, denom_ * other.denom_);
+  std::int64_t a, b, n, d;
+  if (!__builtin_mul_overflow(num_, other.denom_, &a) && !__builtin_mul_overflow(other.num_, denom_, &b) &&
+      !__builtin_add_overflow(a, b, &n) && !__builtin_mul_overflow(denom_, other.denom_, &d))
+    return Fraction(n, d);
+  return fromWide(static_cast<__int128>(num_) * other.denom_ + static_cast<__int128>(other.num_) * denom_,
+                  static_cast<__int128>(denom_) * other.denom_);
 }
 
 Fraction Fraction::operator-(const Fraction& other) const {
-  return Fraction(num_ * other.denom_ - other.num_ * denom_, denom_ * other.denom_);
+  std::int64_t a, b, n, d;
+  if (!__builtin_mul_overflow(num_, other.denom_, &a) && !__builtin_mul_overflow(other.num_, denom_, &b) &&
+      !__builtin_sub_overflow(a, b, &n) && !__builtin_mul_overflow(denom_, other.denom_, &d))
+    return Fraction(n, d);
+  return fromWide(static_cast<__int128>(num_) * other.denom_ - static_cast<__int128>(other.num_) * denom_,
+                  static_cast<__int128>(denom_) * other.denom_);
 }
 
 Fraction Fraction::operator*(const Fraction& other) const {
-  return Fraction(num_ * other.num_, denom_ * other.denom_);
+  std::int64_t n, d;
+  if (!__builtin_mul_overflow(num_, other.num_, &n) && !__builtin_mul_overflow(denom_, other.denom_, &d))
+    return Fraction(n, d);
+  return fromWide(static_cast<__int128>(num_) * other.num_, static_cast<__int128>(denom_) * other.denom_);
 }
 
 Fraction Fraction::operator/(const Fraction& other) const {
   if (other.num_ == 0)
     throw std::invalid_argument("Fraction: division by zero.");
-  return Fraction(num_ * other.denom_, denom_ * other.num_);
+  std::int64_t n, d;
+  if (!__builtin_mul_overflow(num_, other.denom_, &n) && !__builtin_mul_overflow(denom_, other.num_, &d))
+    return Fraction(n, d);
+  return fromWide(static_cast<__int128>(num_) * other.denom_, static_cast<__int128>(denom_) * other.num_);
 }
 
 Fraction Fraction::operator-() const {
@@ -63,15 +119,22 @@ bool Fraction::operator==(const Fraction& other) const {
   return num_ == other.num_ && denom_ == other.denom_;
 }
 
+// Denominators are positive, so a/b > c/d iff a·d > c·b; the products always fit in 128 bits.
 bool Fraction::operator>(const Fraction& other) const {
-  Fraction diff = *this - other;
-  return diff.num_ > 0;
+  if (denom_ == other.denom_) return num_ > other.num_;
+  return static_cast<__int128>(num_) * other.denom_ > static_cast<__int128>(other.num_) * denom_;
 }
 
 Fraction Fraction::abs() const {
   return Fraction(num_ < 0 ? -num_ : num_, denom_);
 }
 
+unsigned Fraction::bitSize() const {
+  const std::uint64_t mag = num_ < 0 ? 0 - static_cast<std::uint64_t>(num_) : static_cast<std::uint64_t>(num_);
+  const std::uint64_t den = static_cast<std::uint64_t>(denom_);
+  return (mag == 0 ? 0 : 64 - __builtin_clzll(mag)) + (64 - __builtin_clzll(den));
+}
+
 Fraction Fraction::fromString(const std::string& s) {
   std::string t;
   for (char c : s) {
@@ -121,9 +184,18 @@ Fraction Fraction::fromString(const std::string& s) {
 }
 
 std::string Fraction::toString() const {
-  if (denom_ == 1)
-    return std::to_string(num_);
-  return std::to_string(num_) + "/" + std::to_string(denom_);
+  char buf[kMaxChars];
+  return std::string(buf, toChars(buf, buf + sizeof(buf)));
+}
+
+char* Fraction::toChars(char* first, char* last) const {
+  std::to_chars_result r = std::to_chars(first, last, num_);
+  if (r.ec != std::errc()) return nullptr;
+  if (denom_ == 1) return r.ptr;
+  if (r.ptr == last) return nullptr;
+  *r.ptr = '/';
+  r = std::to_chars(r.ptr + 1, last, denom_);
+  return r.ec == std::errc() ? r.ptr : nullptr;
 }
 
 double Fraction::toDouble() const {
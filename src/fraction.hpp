@@ -3,6 +3,7 @@
 #ifndef FRACTION_HPP
 #define FRACTION_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -14,6 +15,7 @@ public:
   std::int64_t numerator() const { return num_; }
   std::int64_t denominator() const { return denom_; }
 
+  // Exact; throws std::overflow_error when the result in lowest terms does not fit in 64 bits.
   Fraction operator+(const Fraction& other) const;
   Fraction operator-(const Fraction& other) const;
   Fraction operator*(const Fraction& other) const;
@@ -27,11 +29,17 @@ public:
 
   bool isZero() const { return num_ == 0; }
   Fraction abs() const;
+  // bits(|numerator|) + bits(denominator): the size measure pivot selection tries to keep small.
+  unsigned bitSize() const;
 
   // Parse "a/b", "a", "a.b" (decimal). Invalid/empty -> 0/1.
   static Fraction fromString(const std::string& s);
   // Display as "3", "1/2", "-2/5".
   std::string toString() const;
+  // Same text written into [first, last) without allocating; returns one past the last char written,
+  // or nullptr if the range is too small. kMaxChars always suffices.
+  static constexpr std::size_t kMaxChars = 41;
+  char* toChars(char* first, char* last) const;
 
   double toDouble() const;
 
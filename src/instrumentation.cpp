@@ -0,0 +1,160 @@
+// instrumentation.cpp — Instrumentation snapshot, operation history and JSON export.
+
+#include "instrumentation.hpp"
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <sstream>
+
+namespace instr {
+
+namespace {
+  const std::size_t kMaxHistory = 64;
+
+#ifdef MATRIX_INSTRUMENTATION
+  std::mutex gHistoryMutex;
+  std::deque<OperationRecord> gHistory;
+  OperationRecord gLast;
+#endif
+
+  void appendJsonString(std::ostringstream& oss, const std::string& s) {
+    oss << '"';
+    for (char c : s) {
+      if (c == '"' || c == '\\')
+        oss << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+        oss << buf;
+      } else
+        oss << c;
+    }
+    oss << '"';
+  }
+
+  void appendCounters(std::ostringstream& oss, const Snapshot& s) {
+    oss << "{\"fractionConstructions\":" << s.fractionConstructions
+        << ",\"gcdCalls\":" << s.gcdCalls
+        << ",\"pivotSwaps\":" << s.pivotSwaps
+        << ",\"peakEntryBits\":" << s.peakEntryBits << '}';
+  }
+}
+
+Snapshot snapshot() {
+  Snapshot s;
+#ifdef MATRIX_INSTRUMENTATION
+  const auto& c = detail::gCounters;
+  s.fractionConstructions = c.fractionConstructions.load(std::memory_order_relaxed);
+  s.gcdCalls = c.gcdCalls.load(std::memory_order_relaxed);
+  s.pivotSwaps = c.pivotSwaps.load(std::memory_order_relaxed);
+  s.peakEntryBits = c.peakEntryBits.load(std::memory_order_relaxed);
+#endif
+  return s;
+}
+
+void reset() {
+#ifdef MATRIX_INSTRUMENTATION
+  auto& c = detail::gCounters;
+  c.fractionConstructions.store(0, std::memory_order_relaxed);
+  c.gcdCalls.store(0, std::memory_order_relaxed);
+  c.pivotSwaps.store(0, std::memory_order_relaxed);
+  c.peakEntryBits.store(0, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  gHistory.clear();
+  gLast = OperationRecord();
+#endif
+}
+
+OperationRecord lastOperation() {
+#ifdef MATRIX_INSTRUMENTATION
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  return gLast;
+#else
+  return OperationRecord();
+#endif
+}
+
+std::vector<OperationRecord> history() {
+#ifdef MATRIX_INSTRUMENTATION
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  return std::vector<OperationRecord>(gHistory.begin(), gHistory.end());
+#else
+  return {};
+#endif
+}
+
+std::string toJson() {
+  std::ostringstream oss;
+  oss << "{\"enabled\":" << (enabled() ? "true" : "false") << ",\"totals\":";
+  appendCounters(oss, snapshot());
+  oss << ",\"operations\":[";
+  bool first = true;
+  for (const OperationRecord& rec : history()) {
+    if (!first) oss << ',';
+    first = false;
+    oss << "{\"name\":";
+    appendJsonString(oss, rec.name);
+    oss << ",\"rows\":" << rec.rows << ",\"cols\":" << rec.cols
+        << ",\"depth\":" << rec.depth << ",\"wallMs\":" << rec.wallMs << ",\"counters\":";
+    appendCounters(oss, rec.counters);
+    oss << '}';
+  }
+  oss << "]}";
+  return oss.str();
+}
+
+std::string summary(const OperationRecord& rec) {
+  if (rec.name.empty()) return std::string();
+  char buf[256];
+  std::snprintf(buf, sizeof(buf),
+                "%s %zux%zu: %.3f ms, %llu fractions, %llu gcd, %llu swaps, peak %llu bits",
+                rec.name.c_str(), rec.rows, rec.cols, rec.wallMs,
+                static_cast<unsigned long long>(rec.counters.fractionConstructions),
+                static_cast<unsigned long long>(rec.counters.gcdCalls),
+                static_cast<unsigned long long>(rec.counters.pivotSwaps),
+                static_cast<unsigned long long>(rec.counters.peakEntryBits));
+  return buf;
+}
+
+#ifdef MATRIX_INSTRUMENTATION
+namespace detail {
+
+ScopedOperation::ScopedOperation(const char* name, std::size_t rows, std::size_t cols)
+  : name_(name), rows_(rows), cols_(cols), depth_(tLocal.depth++), start_(tLocal),
+    outerPeak_(tLocal.peakEntryBits), t0_(std::chrono::steady_clock::now()) {
+  tLocal.peakEntryBits = 0;
+}
+
+ScopedOperation::~ScopedOperation() {
+  auto t1 = std::chrono::steady_clock::now();
+  Local& local = tLocal;
+  OperationRecord rec;
+  rec.name = name_;
+  rec.rows = rows_;
+  rec.cols = cols_;
+  rec.depth = depth_;
+  rec.wallMs = std::chrono::duration<double, std::milli>(t1 - t0_).count();
+  rec.counters.fractionConstructions = local.fractionConstructions - start_.fractionConstructions;
+  rec.counters.gcdCalls = local.gcdCalls - start_.gcdCalls;
+  rec.counters.pivotSwaps = local.pivotSwaps - start_.pivotSwaps;
+  rec.counters.peakEntryBits = local.peakEntryBits;
+  // The enclosing scope's peak covers this one too.
+  if (outerPeak_ > local.peakEntryBits) local.peakEntryBits = outerPeak_;
+  if (--local.depth == 0) {
+    gCounters.fractionConstructions.fetch_add(local.fractionConstructions, std::memory_order_relaxed);
+    gCounters.gcdCalls.fetch_add(local.gcdCalls, std::memory_order_relaxed);
+    gCounters.pivotSwaps.fetch_add(local.pivotSwaps, std::memory_order_relaxed);
+    raisePeak(gCounters.peakEntryBits, local.peakEntryBits);
+    local = Local();
+  }
+
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  gHistory.push_back(rec);
+  if (gHistory.size() > kMaxHistory) gHistory.pop_front();
+  if (depth_ == 0) gLast = rec;
+}
+
+} // namespace detail
+#endif
+
+} // namespace instr
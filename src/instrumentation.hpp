@@ -0,0 +1,155 @@
+// instrumentation.hpp — Compile-time switchable hot-path counters and per-operation timing for Fraction/Matrix.
+// Enabled by defining MATRIX_INSTRUMENTATION (CMake option of the same name). When it is not defined,
+// every MATRIX_INSTR_* macro expands to nothing, so Fraction and Matrix compile to the uninstrumented code.
+
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef MATRIX_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace instr {
+
+// Totals since the last reset() (or deltas for one operation in OperationRecord).
+struct Snapshot {
+  std::uint64_t fractionConstructions = 0;
+  std::uint64_t gcdCalls = 0;
+  std::uint64_t pivotSwaps = 0;
+  std::uint64_t peakEntryBits = 0;  // max bits(|num|) + bits(denom) of any normalized Fraction
+};
+
+struct OperationRecord {
+  std::string name;
+  std::size_t rows = 0;
+  std::size_t cols = 0;
+  int depth = 0;          // 0 for top-level operations, >0 when nested inside another
+  double wallMs = 0.0;
+  Snapshot counters;
+};
+
+constexpr bool enabled() {
+#ifdef MATRIX_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Totals; counts from an operation scope that is still open are added when it ends.
+Snapshot snapshot();
+void reset();
+// Most recent completed top-level operation (name is empty if none).
+OperationRecord lastOperation();
+// Recently completed operations, oldest first (bounded).
+std::vector<OperationRecord> history();
+// {"enabled":..,"totals":{..},"operations":[..]} for dashboards.
+std::string toJson();
+// One-line human readable summary of a record, for the status bar.
+std::string summary(const OperationRecord& rec);
+
+#ifdef MATRIX_INSTRUMENTATION
+namespace detail {
+
+// Process-wide totals. Work done inside an operation scope is counted in the thread's Local
+// counters first and merged here when the thread's outermost scope ends, so concurrent operations
+// (async expression nodes, MatrixBatch chunks, daemon workers) never see each other's counts.
+struct Counters {
+  std::atomic<std::uint64_t> fractionConstructions{0};
+  std::atomic<std::uint64_t> gcdCalls{0};
+  std::atomic<std::uint64_t> pivotSwaps{0};
+  std::atomic<std::uint64_t> peakEntryBits{0};
+};
+
+inline Counters gCounters;
+
+// Counts of the calling thread since its outermost open scope began (not yet in gCounters).
+struct Local {
+  std::uint64_t fractionConstructions = 0;
+  std::uint64_t gcdCalls = 0;
+  std::uint64_t pivotSwaps = 0;
+  std::uint64_t peakEntryBits = 0;  // peak within the innermost open scope
+  int depth = 0;                    // open ScopedOperations on this thread
+};
+
+inline thread_local Local tLocal;
+
+inline unsigned bitWidth(std::int64_t v) {
+  std::uint64_t u = v < 0 ? 0 - static_cast<std::uint64_t>(v) : static_cast<std::uint64_t>(v);
+  unsigned bits = 0;
+  while (u != 0) {
+    u >>= 1;
+    ++bits;
+  }
+  return bits;
+}
+
+inline void raisePeak(std::atomic<std::uint64_t>& peak, std::uint64_t bits) {
+  std::uint64_t cur = peak.load(std::memory_order_relaxed);
+  while (bits > cur && !peak.compare_exchange_weak(cur, bits, std::memory_order_relaxed)) {}
+}
+
+inline void recordEntryBits(std::int64_t num, std::int64_t denom) {
+  const std::uint64_t bits = bitWidth(num) + bitWidth(denom);
+  Local& local = tLocal;
+  if (local.depth > 0) {
+    if (bits > local.peakEntryBits) local.peakEntryBits = bits;
+  } else {
+    raisePeak(gCounters.peakEntryBits, bits);
+  }
+}
+
+// Outside any scope counts go straight to the totals; inside one they stay thread-local.
+#define MATRIX_INSTR_BUMP(counter)                                            \
+  do {                                                                        \
+    ::instr::detail::Local& local_ = ::instr::detail::tLocal;                 \
+    if (local_.depth > 0)                                                     \
+      ++local_.counter;                                                       \
+    else                                                                      \
+      ::instr::detail::gCounters.counter.fetch_add(1, std::memory_order_relaxed); \
+  } while (false)
+
+// RAII timer: records wall time and the calling thread's counter deltas for one Matrix operation.
+// Work the operation hands to other threads is recorded by their own scopes, not by this one.
+class ScopedOperation {
+public:
+  ScopedOperation(const char* name, std::size_t rows, std::size_t cols);
+  ~ScopedOperation();
+  ScopedOperation(const ScopedOperation&) = delete;
+  ScopedOperation& operator=(const ScopedOperation&) = delete;
+
+private:
+  const char* name_;
+  std::size_t rows_;
+  std::size_t cols_;
+  int depth_;
+  Local start_;
+  std::uint64_t outerPeak_;
+  std::chrono::steady_clock::time_point t0_;
+};
+
+} // namespace detail
+#endif
+
+} // namespace instr
+
+#ifdef MATRIX_INSTRUMENTATION
+#define MATRIX_INSTR_CAT2(a, b) a##b
+#define MATRIX_INSTR_CAT(a, b) MATRIX_INSTR_CAT2(a, b)
+#define MATRIX_INSTR_COUNT(counter) MATRIX_INSTR_BUMP(counter)
+#define MATRIX_INSTR_ENTRY_BITS(num, denom) ::instr::detail::recordEntryBits((num), (denom))
+#define MATRIX_INSTR_SCOPE(name, rows, cols) \
+  ::instr::detail::ScopedOperation MATRIX_INSTR_CAT(instrScope_, __LINE__)((name), (rows), (cols))
+#else
+#define MATRIX_INSTR_COUNT(counter) ((void)0)
+#define MATRIX_INSTR_ENTRY_BITS(num, denom) ((void)0)
+#define MATRIX_INSTR_SCOPE(name, rows, cols) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_HPP
@@ -1,15 +1,50 @@
 // matrix.hpp — Reusable Matrix class for linear algebra (Fraction-based).
-// Supports construction, accessors, +/−/×/÷, RREF, and inverse (Gauss–Jordan with partial pivoting).
+// Supports construction, accessors, +/−/×/÷, RREF, inverse (Gauss–Jordan with a pluggable pivot policy),
+// integer powers, determinant, trace, characteristic polynomial and eigenvalues.
+// Storage is reference-counted copy-on-write: copies, transposes and block/row/column views share
+// entries in O(1) and every operation reads them in place; the first write through a shared
+// Matrix gives it its own dense copy. A Fraction& obtained from operator() is invalidated by
+// copying that Matrix (the copy may share the entry) — finish writing before copying.
 
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
 #include "fraction.hpp"
+#include "polynomial.hpp"
+#include <atomic>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
+// Berkowitz is division-free, O(n⁴) in Fraction arithmetic. Hessenberg reduction is O(n³) but needs
+// a field, and over the rationals its entries outgrow int64 from about 6x6; it runs modulo primes
+// near 2^62 instead and rebuilds the exact coefficients, falling back to Berkowitz only for entries
+// or coefficient bounds beyond about 120 bits. charpoly() without a method takes Hessenberg from 6x6.
+enum class CharpolyMethod { Berkowitz, Hessenberg };
+
+// Pivot choice for Gauss–Jordan. Exact arithmetic has no rounding error to control, so the default
+// takes the nonzero candidate with the fewest bits, which keeps intermediate entries (and the gcd
+// work on them) small; LargestMagnitude is classic partial pivoting.
+enum class PivotStrategy { SmallestBitSize, LargestMagnitude, FirstNonzero };
+
+struct PivotPolicy {
+  PivotStrategy strategy = PivotStrategy::SmallestBitSize;
+  // Prefer pivot rows with the fewest nonzeros (ties broken by strategy) to limit fill-in.
+  // inverse() also eliminates the sparsest remaining column first and unpermutes the result;
+  // rref() keeps the column order, since reordering columns would change the echelon form.
+  bool reorderBySparsity = false;
+};
+
+// Eigenvalues with multiplicity: exact rational ones, and approximations of the rest.
+struct Eigenvalues {
+  std::vector<Fraction> exact;
+  std::vector<std::complex<double>> approximate;
+};
+
 class Matrix {
 public:
   // --- Construction ---
@@ -30,9 +65,36 @@ public:
   Matrix operator*(const Fraction& scalar) const;
   Matrix operator/(const Fraction& scalar) const;
 
+  // --- Zero-copy views (O(1), copy-on-write) ---
+  Matrix transpose() const;
+  Matrix block(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const;
+  Matrix rowRange(std::size_t first, std::size_t count) const { return block(first, 0, count, cols_); }
+  Matrix colRange(std::size_t first, std::size_t count) const { return block(0, first, rows_, count); }
+  Matrix row(std::size_t r) const { return rowRange(r, 1); }
+  Matrix col(std::size_t c) const { return colRange(c, 1); }
+  bool isContiguous() const;  // dense row-major storage of its own (not a strided view)
+  bool sharesStorageWith(const Matrix& other) const { return storage_ == other.storage_; }
+
+  // True when every entry is an integer (denominator 1). Then +, −, × and rref()/inverse() run
+  // overflow-checked int64 kernels and fall back to Fraction arithmetic if a value leaves 64 bits.
+  bool isIntegral() const;
+
   // --- RREF and inverse ---
-  Matrix rref() const;
-  Matrix inverse() const;
+  Matrix rref(const PivotPolicy& policy = PivotPolicy()) const;
+  Matrix inverse(const PivotPolicy& policy = PivotPolicy()) const;
+
+  // --- Powers (square only) ---
+  // A^k by repeated squaring, or for large k by reducing x^k modulo the characteristic polynomial
+  // (Cayley–Hamilton). A^0 is the identity; negative k raises inverse() to −k, so a singular
+  // matrix throws std::runtime_error. Throws std::overflow_error if A^k leaves 64-bit fractions.
+  Matrix pow(std::int64_t k) const;
+
+  // --- Determinant, trace, characteristic polynomial det(xI − A), eigenvalues (square only) ---
+  Fraction determinant() const;
+  Fraction trace() const;
+  Polynomial charpoly() const;
+  Polynomial charpoly(CharpolyMethod method) const;
+  Eigenvalues eigenvalues() const;
 
   // --- Comparison (exact equality for Fraction) ---
   static bool approxEqual(const Matrix& a, const Matrix& b);
@@ -40,10 +102,49 @@ public:
 private:
   std::size_t rows_;
   std::size_t cols_;
-  std::vector<Fraction> data_;  // row-major: index = row * cols_ + col
+  // Element (row, col) is (*storage_)[offset_ + row * rowStride_ + col * colStride_].
+  std::shared_ptr<std::vector<Fraction>> storage_;
+  std::size_t offset_;
+  std::size_t rowStride_;
+  std::size_t colStride_;
+  // Whether every denominator is 1: isIntegral() scans once and caches the answer, non-const
+  // operator() resets it to Unknown. Relaxed atomic, since const Matrices are read (and so scanned)
+  // from several threads at once.
+  enum class Integrality : unsigned char { Unknown, Yes, No };
+  class IntegralityCache {
+  public:
+    explicit IntegralityCache(Integrality state) : state_(state) {}
+    IntegralityCache(const IntegralityCache& other) : state_(other.get()) {}
+    IntegralityCache& operator=(const IntegralityCache& other) {
+      set(other.get());
+      return *this;
+    }
+    Integrality get() const { return state_.load(std::memory_order_relaxed); }
+    void set(Integrality state) const { state_.store(state, std::memory_order_relaxed); }
+
+  private:
+    mutable std::atomic<Integrality> state_;
+  };
+  IntegralityCache integral_;
+
+  // Adopts dense row-major entries.
+  Matrix(std::size_t rows, std::size_t cols, std::shared_ptr<std::vector<Fraction>> dense, Integrality integral);
 
   void boundsCheck(std::size_t row, std::size_t col) const;
-  std::size_t index(std::size_t row, std::size_t col) const { return row * cols_ + col; }
+  void detach();          // give this Matrix its own dense row-major copy of its entries
+  Fraction* denseData();  // detach() if shared or strided; then row-major with stride cols_
+  std::vector<std::int64_t> integerEntries() const;  // numerators, dense row-major
+  static Matrix fromIntegers(std::size_t rows, std::size_t cols, const std::vector<std::int64_t>& values);
+  bool integerSum(const Matrix& other, bool subtract, Matrix& result) const;
+  bool integerRref(Matrix& result, const PivotPolicy& policy) const;
+  bool integerInverse(Matrix& result, const PivotPolicy& policy) const;
+  void requireSquare(const char* operation) const;
+  Polynomial charpolyBerkowitz() const;
+  bool charpolyHessenberg(Polynomial& out) const;
+  std::size_t index(std::size_t row, std::size_t col) const {
+    return offset_ + row * rowStride_ + col * colStride_;
+  }
+  const Fraction* base() const { return storage_->data(); }
 };
 
 // scalar * Matrix (non-member)
@@ -0,0 +1,414 @@
+// matrix_batch.cpp — MatrixBatch implementation: batch-interleaved storage, chunked threading, kernels.
+
+#include "matrix_batch.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+  const std::size_t kMinChunk = 256;  // matrices per thread before another thread is worth starting
+  std::atomic<unsigned> gThreadCount{0};
+
+  // Runs fn(begin, end) over [0, count) split into contiguous chunks, one per worker thread.
+  // Exceptions are rethrown in chunk order, so the lowest failing batch index wins.
+  template <typename Fn>
+  void forEachChunk(std::size_t count, Fn fn) {
+    unsigned threads = gThreadCount.load(std::memory_order_relaxed);
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t chunks = std::min<std::size_t>(threads, (count + kMinChunk - 1) / kMinChunk);
+    if (chunks <= 1) {
+      fn(std::size_t(0), count);
+      return;
+    }
+    const std::size_t per = (count + chunks - 1) / chunks;
+    std::vector<std::exception_ptr> errors(chunks);
+    auto runChunk = [&](std::size_t c) {
+      try {
+        fn(c * per, std::min(count, (c + 1) * per));
+      } catch (...) {
+        errors[c] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (std::size_t c = 1; c < chunks; ++c)
+      workers.emplace_back(runChunk, c);
+    runChunk(0);
+    for (auto& w : workers) w.join();
+    for (auto& e : errors)
+      if (e) std::rethrow_exception(e);
+  }
+
+  // Gauss–Jordan on a dense row-major rows×width block, pivoting only in the first pivotCols columns.
+  // Exact arithmetic makes any nonzero pivot valid, so the first one is taken. Returns the rank found.
+  std::size_t gaussJordan(Fraction* a, std::size_t rows, std::size_t width, std::size_t pivotCols) {
+    std::size_t r = 0;
+    for (std::size_t lead = 0; lead < pivotCols && r < rows; ++lead) {
+      std::size_t p = r;
+      while (p < rows && a[p * width + lead].isZero()) ++p;
+      if (p == rows) continue;
+      if (p != r) {
+        MATRIX_INSTR_COUNT(pivotSwaps);
+        std::swap_ranges(a + p * width, a + (p + 1) * width, a + r * width);
+      }
+      Fraction* pr = a + r * width;
+      const Fraction pivot = pr[lead];
+      for (std::size_t c = lead; c < width; ++c)
+        pr[c] = pr[c] / pivot;
+      for (std::size_t i = 0; i < rows; ++i) {
+        if (i == r) continue;
+        Fraction* ri = a + i * width;
+        const Fraction factor = ri[lead];
+        if (factor.isZero()) continue;
+        for (std::size_t c = lead; c < width; ++c)
+          ri[c] = ri[c] - factor * pr[c];
+      }
+      ++r;
+    }
+    return r;
+  }
+
+  // Determinant of a dense row-major n×n block by fraction Gaussian elimination (destroys a).
+  Fraction eliminateDeterminant(Fraction* a, std::size_t n) {
+    Fraction det(1, 1);
+    for (std::size_t k = 0; k < n; ++k) {
+      std::size_t p = k;
+      while (p < n && a[p * n + k].isZero()) ++p;
+      if (p == n) return Fraction(0, 1);
+      if (p != k) {
+        MATRIX_INSTR_COUNT(pivotSwaps);
+        std::swap_ranges(a + p * n, a + (p + 1) * n, a + k * n);
+        det = -det;
+      }
+      const Fraction pivot = a[k * n + k];
+      det = det * pivot;
+      for (std::size_t i = k + 1; i < n; ++i) {
+        const Fraction factor = a[i * n + k] / pivot;
+        if (factor.isZero()) continue;
+        for (std::size_t c = k + 1; c < n; ++c)
+          a[i * n + c] = a[i * n + c] - factor * a[k * n + c];
+      }
+    }
+    return det;
+  }
+
+  const std::size_t kLanes = 64;  // matrices per integer kernel block, so a block's entries stay in cache
+
+  // Numerators of matrices [b, b + m) of an interleaved rows×cols batch into a lane block: entry
+  // (i, j) of lane l at out[(i * width + j) * kLanes + l]. Lanes with a non-integer entry, or one
+  // whose negation overflows, are flagged in bad.
+  void loadLanes(const Fraction* data, std::size_t count, std::size_t rows, std::size_t cols, std::size_t width,
+                 std::size_t b, std::size_t m, std::int64_t* out, unsigned char* bad) {
+    for (std::size_t i = 0; i < rows; ++i)
+      for (std::size_t j = 0; j < cols; ++j) {
+        const Fraction* in = data + (i * cols + j) * count + b;
+        std::int64_t* lane = out + (i * width + j) * kLanes;
+        for (std::size_t l = 0; l < m; ++l) {
+          lane[l] = in[l].numerator();
+          bad[l] |= in[l].denominator() != 1 || lane[l] == INT64_MIN;
+        }
+      }
+  }
+
+  // Largest |entry| over the first m lanes of a lane block.
+  std::uint64_t laneMagnitude(const std::vector<std::int64_t>& v, std::size_t m) {
+    std::uint64_t most = 0;
+    for (std::size_t e = 0; e < v.size(); e += kLanes)
+      for (std::size_t l = 0; l < m; ++l) {
+        const std::uint64_t x = v[e + l] < 0 ? 0 - static_cast<std::uint64_t>(v[e + l]) : static_cast<std::uint64_t>(v[e + l]);
+        most = std::max(most, x);
+      }
+    return most;
+  }
+
+  // Fraction-free (Bareiss) elimination on m lanes of rows×width integer blocks laid out as by
+  // loadLanes, pivoting on the diagonal of the first steps columns. Every entry stays a minor of
+  // the input, so the division by the previous pivot is exact. With jordan the rows above each
+  // pivot are cleared as well, and every pivot row ends up scaled by the last pivot, which is
+  // returned per lane in last (the determinant of the leading steps×steps block). A lane that
+  // meets a zero pivot or overflows int64 is flagged in bad and must be redone with Fractions.
+  void bareissLanes(std::int64_t* v, unsigned char* bad, std::size_t m, std::size_t rows, std::size_t width,
+                    std::size_t steps, bool jordan, std::int64_t* last) {
+    std::int64_t prev[kLanes];
+    std::int64_t piv[kLanes];
+    std::fill(prev, prev + m, std::int64_t(1));
+    for (std::size_t k = 0; k < steps; ++k) {
+      const std::int64_t* pk = v + k * width * kLanes;
+      for (std::size_t l = 0; l < m; ++l) {
+        piv[l] = pk[k * kLanes + l];
+        bad[l] |= piv[l] == 0;
+        if (bad[l]) piv[l] = 1;  // keeps a flagged lane's divisions defined
+      }
+      for (std::size_t i = jordan ? 0 : k + 1; i < rows; ++i) {
+        if (i == k) continue;
+        std::int64_t* ri = v + i * width * kLanes;
+        const std::int64_t* factor = ri + k * kLanes;
+        for (std::size_t j = k + 1; j < width; ++j) {
+          std::int64_t* rij = ri + j * kLanes;
+          const std::int64_t* pkj = pk + j * kLanes;
+          for (std::size_t l = 0; l < m; ++l) {
+            std::int64_t x, y, d;
+            bad[l] |= __builtin_mul_overflow(piv[l], rij[l], &x) | __builtin_mul_overflow(factor[l], pkj[l], &y) |
+                      __builtin_sub_overflow(x, y, &d) | (d == INT64_MIN);
+            if (d == INT64_MIN) d = 0;  // INT64_MIN / -1 traps
+            rij[l] = d / prev[l];
+          }
+        }
+        std::fill(ri + k * kLanes, ri + k * kLanes + m, std::int64_t(0));
+      }
+      std::copy(piv, piv + m, prev);
+    }
+    std::copy(prev, prev + m, last);
+  }
+
+}
+
+MatrixBatch::MatrixBatch(std::size_t count, std::size_t rows, std::size_t cols)
+  : count_(count), rows_(rows), cols_(cols), data_(count * rows * cols, Fraction(0, 1)) {}
+
+MatrixBatch::MatrixBatch(const std::vector<Matrix>& matrices)
+  : count_(matrices.size()),
+    rows_(matrices.empty() ? 0 : matrices[0].rows()),
+    cols_(matrices.empty() ? 0 : matrices[0].cols()),
+    data_(count_ * rows_ * cols_, Fraction(0, 1)) {
+  for (std::size_t b = 0; b < count_; ++b)
+    set(b, matrices[b]);
+}
+
+void MatrixBatch::boundsCheck(std::size_t b, std::size_t row, std::size_t col) const {
+#ifdef NDEBUG
+  (void)b;
+  (void)row;
+  (void)col;
+#else
+  if (b >= count_ || row >= rows_ || col >= cols_) {
+    std::ostringstream oss;
+    oss << "MatrixBatch index out of bounds: [" << b << "](" << row << ", " << col
+        << ") for batch of " << count_ << " matrices of size " << rows_ << "x" << cols_;
+    throw std::out_of_range(oss.str());
+  }
+#endif
+}
+
+Fraction& MatrixBatch::operator()(std::size_t b, std::size_t row, std::size_t col) {
+  boundsCheck(b, row, col);
+  return data_[index(b, row, col)];
+}
+
+const Fraction& MatrixBatch::operator()(std::size_t b, std::size_t row, std::size_t col) const {
+  boundsCheck(b, row, col);
+  return data_[index(b, row, col)];
+}
+
+Matrix MatrixBatch::get(std::size_t b) const {
+  Matrix m(rows_, cols_);
+  for (std::size_t i = 0; i < rows_; ++i)
+    for (std::size_t j = 0; j < cols_; ++j)
+      m(i, j) = (*this)(b, i, j);
+  return m;
+}
+
+void MatrixBatch::set(std::size_t b, const Matrix& m) {
+  if (m.rows() != rows_ || m.cols() != cols_) {
+    std::ostringstream oss;
+    oss << "MatrixBatch: shape mismatch (" << m.rows() << "x" << m.cols()
+        << ") in batch of " << rows_ << "x" << cols_ << " matrices";
+    throw std::invalid_argument(oss.str());
+  }
+  for (std::size_t i = 0; i < rows_; ++i)
+    for (std::size_t j = 0; j < cols_; ++j)
+      (*this)(b, i, j) = m(i, j);
+}
+
+void MatrixBatch::setThreadCount(unsigned threads) {
+  gThreadCount.store(threads, std::memory_order_relaxed);
+}
+
+MatrixBatch MatrixBatch::operator*(const MatrixBatch& other) const {
+  MATRIX_INSTR_SCOPE("batch multiply", rows_, other.cols_);
+  if (count_ != other.count_ || cols_ != other.rows_) {
+    std::ostringstream oss;
+    oss << "MatrixBatch multiplication: mismatch (" << count_ << " x " << rows_ << "x" << cols_
+        << ") * (" << other.count_ << " x " << other.rows_ << "x" << other.cols_ << ")";
+    throw std::invalid_argument(oss.str());
+  }
+  const std::size_t p = other.cols_;
+  MatrixBatch result(count_, rows_, p);
+  forEachChunk(count_, [&](std::size_t b0, std::size_t b1) {
+    std::vector<std::int64_t> va(rows_ * cols_ * kLanes), vb(cols_ * p * kLanes);
+    std::int64_t acc[kLanes];
+    unsigned char bad[kLanes];
+    for (std::size_t b = b0; b < b1; b += kLanes) {
+      const std::size_t m = std::min(kLanes, b1 - b);
+      std::fill(bad, bad + m, 0);
+      loadLanes(data_.data(), count_, rows_, cols_, cols_, b, m, va.data(), bad);
+      loadLanes(other.data_.data(), count_, cols_, p, p, b, m, vb.data(), bad);
+      // When the block's largest entries cannot overflow a dot product, skip the per-step checks.
+      unsigned __int128 bound;
+      const bool fits = !__builtin_mul_overflow(static_cast<unsigned __int128>(laneMagnitude(va, m)) *
+                                                    laneMagnitude(vb, m), cols_, &bound) &&
+                        bound <= static_cast<unsigned __int128>(INT64_MAX);
+      for (std::size_t i = 0; i < rows_; ++i)
+        for (std::size_t j = 0; j < p; ++j) {
+          std::fill(acc, acc + m, std::int64_t(0));
+          for (std::size_t k = 0; k < cols_; ++k) {
+            const std::int64_t* a = &va[(i * cols_ + k) * kLanes];
+            const std::int64_t* c = &vb[(k * p + j) * kLanes];
+            if (fits) {
+              for (std::size_t l = 0; l < m; ++l) acc[l] += a[l] * c[l];
+              continue;
+            }
+            for (std::size_t l = 0; l < m; ++l) {
+              std::int64_t t;
+              bad[l] |= __builtin_mul_overflow(a[l], c[l], &t) | __builtin_add_overflow(acc[l], t, &acc[l]);
+            }
+          }
+          Fraction* out = &result.data_[result.index(b, i, j)];
+          for (std::size_t l = 0; l < m; ++l)
+            if (!bad[l]) out[l] = Fraction(acc[l]);
+        }
+      // Fraction lanes and lanes that overflowed int64.
+      for (std::size_t l = 0; l < m; ++l) {
+        if (!bad[l]) continue;
+        for (std::size_t i = 0; i < rows_; ++i)
+          for (std::size_t j = 0; j < p; ++j) {
+            Fraction sum(0, 1);
+            for (std::size_t k = 0; k < cols_; ++k)
+              sum = sum + data_[index(b + l, i, k)] * other.data_[other.index(b + l, k, j)];
+            result.data_[result.index(b + l, i, j)] = sum;
+          }
+      }
+    }
+  });
+  return result;
+}
+
+MatrixBatch MatrixBatch::inverse() const {
+  MATRIX_INSTR_SCOPE("batch inverse", rows_, cols_);
+  if (rows_ != cols_) {
+    std::ostringstream oss;
+    oss << "MatrixBatch inverse: matrices must be square (got " << rows_ << "x" << cols_ << ").";
+    throw std::invalid_argument(oss.str());
+  }
+  const std::size_t n = rows_;
+  const std::size_t w = 2 * n;
+  MatrixBatch result(count_, n, n);
+  forEachChunk(count_, [&](std::size_t b0, std::size_t b1) {
+    // Fraction-free Gauss–Jordan turns [A | I] into [det·I | adj A], so A⁻¹ = adj A / det.
+    std::vector<std::int64_t> v(n * w * kLanes);
+    std::vector<Fraction> aug(n * w);
+    std::int64_t det[kLanes];
+    unsigned char bad[kLanes];
+    for (std::size_t b = b0; b < b1; b += kLanes) {
+      const std::size_t m = std::min(kLanes, b1 - b);
+      std::fill(bad, bad + m, 0);
+      loadLanes(data_.data(), count_, n, n, w, b, m, v.data(), bad);
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+          std::fill_n(&v[(i * w + n + j) * kLanes], m, std::int64_t(i == j ? 1 : 0));
+      bareissLanes(v.data(), bad, m, n, w, n, true, det);
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j) {
+          const std::int64_t* adj = &v[(i * w + n + j) * kLanes];
+          Fraction* out = &result.data_[result.index(b, i, j)];
+          for (std::size_t l = 0; l < m; ++l)
+            if (!bad[l]) out[l] = Fraction(adj[l], det[l]);
+        }
+      // Fraction lanes, overflowing lanes and lanes with a zero pivot (which include the singular ones).
+      for (std::size_t l = 0; l < m; ++l) {
+        if (!bad[l]) continue;
+        for (std::size_t i = 0; i < n; ++i)
+          for (std::size_t j = 0; j < n; ++j) {
+            aug[i * w + j] = data_[index(b + l, i, j)];
+            aug[i * w + n + j] = Fraction(i == j ? 1 : 0, 1);
+          }
+        if (gaussJordan(aug.data(), n, w, n) < n) {
+          std::ostringstream oss;
+          oss << "MatrixBatch inverse: matrix " << b + l << " is singular.";
+          throw std::runtime_error(oss.str());
+        }
+        for (std::size_t i = 0; i < n; ++i)
+          for (std::size_t j = 0; j < n; ++j)
+            result.data_[result.index(b + l, i, j)] = aug[i * w + n + j];
+      }
+    }
+  });
+  return result;
+}
+
+std::vector<Fraction> MatrixBatch::determinant() const {
+  MATRIX_INSTR_SCOPE("batch determinant", rows_, cols_);
+  if (rows_ != cols_) {
+    std::ostringstream oss;
+    oss << "MatrixBatch determinant: matrices must be square (got " << rows_ << "x" << cols_ << ").";
+    throw std::invalid_argument(oss.str());
+  }
+  const std::size_t n = rows_;
+  std::vector<Fraction> dets(count_);
+  forEachChunk(count_, [&](std::size_t b0, std::size_t b1) {
+    // Fraction-free elimination leaves the determinant as the last pivot.
+    std::vector<std::int64_t> v(n * n * kLanes);
+    std::vector<Fraction> a(n * n);
+    std::int64_t det[kLanes];
+    unsigned char bad[kLanes];
+    for (std::size_t b = b0; b < b1; b += kLanes) {
+      const std::size_t m = std::min(kLanes, b1 - b);
+      std::fill(bad, bad + m, 0);
+      loadLanes(data_.data(), count_, n, n, n, b, m, v.data(), bad);
+      bareissLanes(v.data(), bad, m, n, n, n, false, det);
+      for (std::size_t l = 0; l < m; ++l) {
+        if (!bad[l]) {
+          dets[b + l] = Fraction(det[l]);
+          continue;
+        }
+        for (std::size_t e = 0; e < n * n; ++e)
+          a[e] = data_[e * count_ + b + l];
+        dets[b + l] = eliminateDeterminant(a.data(), n);
+      }
+    }
+  });
+  return dets;
+}
+
+MatrixBatch MatrixBatch::rref() const {
+  MATRIX_INSTR_SCOPE("batch rref", rows_, cols_);
+  MatrixBatch result(count_, rows_, cols_);
+  const std::size_t elems = rows_ * cols_;
+  const std::size_t steps = std::min(rows_, cols_);
+  forEachChunk(count_, [&](std::size_t b0, std::size_t b1) {
+    // Lanes of full rank with nonzero leading pivots come out of fraction-free Gauss–Jordan as
+    // [d·I | X] over zero rows, whose rref is [I | X/d] over zero rows.
+    std::vector<std::int64_t> v(elems * kLanes);
+    std::vector<Fraction> a(elems);
+    std::int64_t d[kLanes];
+    unsigned char bad[kLanes];
+    for (std::size_t b = b0; b < b1; b += kLanes) {
+      const std::size_t m = std::min(kLanes, b1 - b);
+      std::fill(bad, bad + m, 0);
+      loadLanes(data_.data(), count_, rows_, cols_, cols_, b, m, v.data(), bad);
+      bareissLanes(v.data(), bad, m, rows_, cols_, steps, true, d);
+      for (std::size_t i = 0; i < steps; ++i)
+        for (std::size_t j = 0; j < cols_; ++j) {
+          const std::int64_t* x = &v[(i * cols_ + j) * kLanes];
+          Fraction* out = &result.data_[result.index(b, i, j)];
+          for (std::size_t l = 0; l < m; ++l)
+            if (!bad[l]) out[l] = j < steps ? Fraction(i == j ? 1 : 0) : Fraction(x[l], d[l]);
+        }
+      for (std::size_t l = 0; l < m; ++l) {
+        if (!bad[l]) continue;
+        for (std::size_t e = 0; e < elems; ++e)
+          a[e] = data_[e * count_ + b + l];
+        gaussJordan(a.data(), rows_, cols_, cols_);
+        for (std::size_t e = 0; e < elems; ++e)
+          result.data_[e * count_ + b + l] = a[e];
+      }
+    }
+  });
+  return result;
+}
@@ -0,0 +1,52 @@
+// matrix_batch.hpp — N same-shaped small matrices stored batch-interleaved, with batched kernels.
+// Element (row, col) of matrix b lives at index (row * cols + col) * size() + b, so every kernel's
+// innermost loop runs over the batch with unit stride. Chunks of the batch are spread over threads.
+// Integer matrices go through overflow-checked int64 kernels (fraction-free elimination for
+// inverse, determinant and rref); a matrix holding a fraction, meeting a zero diagonal pivot or
+// overflowing int64 is redone on its own with Fraction arithmetic.
+
+#ifndef MATRIX_BATCH_HPP
+#define MATRIX_BATCH_HPP
+
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include <cstddef>
+#include <vector>
+
+class MatrixBatch {
+public:
+  MatrixBatch(std::size_t count, std::size_t rows, std::size_t cols);
+  // All matrices must share the shape of the first one.
+  explicit MatrixBatch(const std::vector<Matrix>& matrices);
+
+  std::size_t size() const { return count_; }
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  Fraction& operator()(std::size_t b, std::size_t row, std::size_t col);
+  const Fraction& operator()(std::size_t b, std::size_t row, std::size_t col) const;
+
+  Matrix get(std::size_t b) const;
+  void set(std::size_t b, const Matrix& m);
+
+  // --- Batched kernels (element-wise across the batch) ---
+  MatrixBatch operator*(const MatrixBatch& other) const;
+  MatrixBatch inverse() const;               // throws std::runtime_error naming the first singular matrix
+  std::vector<Fraction> determinant() const; // one determinant per matrix
+  MatrixBatch rref() const;
+
+  // Worker threads used by the kernels; 0 (default) means std::thread::hardware_concurrency().
+  static void setThreadCount(unsigned threads);
+
+private:
+  std::size_t count_;
+  std::size_t rows_;
+  std::size_t cols_;
+  std::vector<Fraction> data_;  // batch-interleaved, see file comment
+
+  void boundsCheck(std::size_t b, std::size_t row, std::size_t col) const;
+  std::size_t index(std::size_t b, std::size_t row, std::size_t col) const {
+    return (row * cols_ + col) * count_ + b;
+  }
+};
+
+#endif // MATRIX_BATCH_HPP
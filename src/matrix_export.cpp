@@ -0,0 +1,224 @@
+// matrix_export.cpp — MatrixExporter implementation: buffered to_chars formatting and binary I/O.
+
+#include "matrix_export.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+  const char kBinaryMagic[4] = {'M', 'T', 'X', 'Q'};
+  const std::uint32_t kBinaryVersion = 1;
+
+  std::uint64_t readUint(std::istream& in, std::size_t bytes) {
+    unsigned char buf[8];
+    if (!in.read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(bytes)))
+      throw std::runtime_error("Matrix import: unexpected end of binary data.");
+    std::uint64_t v = 0;
+    for (std::size_t i = bytes; i-- > 0;)
+      v = (v << 8) | buf[i];
+    return v;
+  }
+
+  const std::uint64_t kEntryBytes = 16;            // int64 numerator, int64 denominator
+  const std::uint64_t kUnsizedReserve = 1 << 16;  // entries reserved up front for a stream of unknown length
+
+  Fraction readEntry(std::istream& in) {
+    const auto num = static_cast<std::int64_t>(readUint(in, 8));
+    const auto den = static_cast<std::int64_t>(readUint(in, 8));
+    if (den == 0) throw std::runtime_error("Matrix import: zero denominator in binary data.");
+    return Fraction(num, den);
+  }
+}
+
+MatrixExporter::MatrixExporter(std::ostream& out, std::size_t bufferSize)
+  : out_(out), buffer_(std::max<std::size_t>(bufferSize, 2 * Fraction::kMaxChars + 16)), used_(0) {}
+
+MatrixExporter::~MatrixExporter() {
+  try {
+    flush();
+  } catch (...) {
+  }
+}
+
+void MatrixExporter::flush() {
+  if (used_ > 0) {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+    used_ = 0;
+  }
+  out_.flush();
+  if (!out_) throw std::runtime_error("Matrix export: write failed.");
+}
+
+char* MatrixExporter::reserve(std::size_t n) {
+  if (buffer_.size() - used_ < n) {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+    used_ = 0;
+  }
+  return buffer_.data() + used_;
+}
+
+void MatrixExporter::append(const char* text, std::size_t n) {
+  while (n > 0) {
+    std::size_t chunk = std::min(n, buffer_.size());
+    std::memcpy(reserve(chunk), text, chunk);
+    used_ += chunk;
+    text += chunk;
+    n -= chunk;
+  }
+}
+
+void MatrixExporter::appendChar(char c) {
+  *reserve(1) = c;
+  ++used_;
+}
+
+void MatrixExporter::appendLiteral(const char* text) {
+  append(text, std::strlen(text));
+}
+
+void MatrixExporter::appendFraction(const Fraction& f) {
+  char* p = reserve(Fraction::kMaxChars);
+  used_ = static_cast<std::size_t>(f.toChars(p, p + Fraction::kMaxChars) - buffer_.data());
+}
+
+void MatrixExporter::appendUint(std::uint64_t v, std::size_t bytes) {
+  char* p = reserve(bytes);
+  for (std::size_t i = 0; i < bytes; ++i) {
+    p[i] = static_cast<char>(v & 0xff);
+    v >>= 8;
+  }
+  used_ += bytes;
+}
+
+void MatrixExporter::write(const Matrix& M, ExportFormat format) {
+  MATRIX_INSTR_SCOPE("export", M.rows(), M.cols());
+  switch (format) {
+    case ExportFormat::Csv: writeCsv(M); break;
+    case ExportFormat::Latex: writeLatex(M); break;
+    case ExportFormat::Binary: writeBinary(M); break;
+  }
+}
+
+void MatrixExporter::writeCsv(const Matrix& M) {
+  for (std::size_t i = 0; i < M.rows(); ++i) {
+    for (std::size_t j = 0; j < M.cols(); ++j) {
+      if (j > 0) appendChar(',');
+      appendFraction(M(i, j));
+    }
+    appendChar('\n');
+  }
+}
+
+void MatrixExporter::writeLatex(const Matrix& M) {
+  appendLiteral("\\begin{pmatrix}\n");
+  for (std::size_t i = 0; i < M.rows(); ++i) {
+    for (std::size_t j = 0; j < M.cols(); ++j) {
+      if (j > 0) appendLiteral(" & ");
+      const Fraction& f = M(i, j);
+      if (f.denominator() == 1) {
+        appendFraction(f);
+        continue;
+      }
+      // \frac{|num|}{den}, with the sign in front
+      char* p = reserve(2 * Fraction::kMaxChars + 16);
+      char* end = p + 2 * Fraction::kMaxChars + 16;
+      std::int64_t num = f.numerator();
+      if (num < 0) *p++ = '-';
+      std::memcpy(p, "\\frac{", 6);
+      p += 6;
+      std::uint64_t mag = num < 0 ? 0 - static_cast<std::uint64_t>(num) : static_cast<std::uint64_t>(num);
+      p = std::to_chars(p, end, mag).ptr;
+      *p++ = '}';
+      *p++ = '{';
+      p = std::to_chars(p, end, f.denominator()).ptr;
+      *p++ = '}';
+      used_ = static_cast<std::size_t>(p - buffer_.data());
+    }
+    appendLiteral(i + 1 < M.rows() ? " \\\\\n" : "\n");
+  }
+  appendLiteral("\\end{pmatrix}\n");
+}
+
+void MatrixExporter::writeBinary(const Matrix& M) {
+  append(kBinaryMagic, sizeof(kBinaryMagic));
+  appendUint(kBinaryVersion, 4);
+  appendUint(M.rows(), 8);
+  appendUint(M.cols(), 8);
+  for (std::size_t i = 0; i < M.rows(); ++i)
+    for (std::size_t j = 0; j < M.cols(); ++j) {
+      const Fraction& f = M(i, j);
+      appendUint(static_cast<std::uint64_t>(f.numerator()), 8);
+      appendUint(static_cast<std::uint64_t>(f.denominator()), 8);
+    }
+}
+
+void exportMatrixToFile(const Matrix& M, const std::string& path, ExportFormat format) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("Matrix export: cannot open " + path + " for writing.");
+  MatrixExporter exporter(out);
+  exporter.write(M, format);
+  exporter.flush();
+}
+
+std::string exportMatrixToString(const Matrix& M, ExportFormat format) {
+  std::ostringstream out;
+  {
+    MatrixExporter exporter(out);
+    exporter.write(M, format);
+    exporter.flush();
+  }
+  return out.str();
+}
+
+ExportFormat exportFormatForPath(const std::string& path) {
+  std::string ext;
+  std::size_t dot = path.rfind('.');
+  if (dot != std::string::npos)
+    for (char c : path.substr(dot + 1))
+      ext += static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+  if (ext == "csv") return ExportFormat::Csv;
+  if (ext == "tex") return ExportFormat::Latex;
+  return ExportFormat::Binary;
+}
+
+Matrix importMatrixBinary(std::istream& in) {
+  char magic[4];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0)
+    throw std::runtime_error("Matrix import: not a binary matrix (bad magic).");
+  const std::uint64_t version = readUint(in, 4);
+  if (version != kBinaryVersion)
+    throw std::runtime_error("Matrix import: unsupported binary version " + std::to_string(version) + ".");
+  const std::uint64_t rows = readUint(in, 8);
+  const std::uint64_t cols = readUint(in, 8);
+  std::uint64_t count;
+  if (__builtin_mul_overflow(rows, cols, &count) || count > std::numeric_limits<std::size_t>::max() / kEntryBytes)
+    throw std::runtime_error("Matrix import: binary header claims an impossible " + std::to_string(rows) + "x" +
+                             std::to_string(cols) + " matrix.");
+  const std::istream::pos_type start = in.tellg();
+  if (start == std::istream::pos_type(-1)) {
+    // Not seekable, so the header cannot be checked against the data: buffer what actually arrives.
+    std::vector<Fraction> entries;
+    entries.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, kUnsizedReserve)));
+    while (entries.size() < count) entries.push_back(readEntry(in));
+    Matrix M(static_cast<std::size_t>(rows), static_cast<std::size_t>(cols));
+    for (std::size_t e = 0; e < count; ++e) M(e / cols, e % cols) = entries[e];
+    return M;
+  }
+  // Refuse a header that promises more entries than the stream holds before allocating for them.
+  in.seekg(0, std::ios::end);
+  const std::istream::pos_type end = in.tellg();
+  in.seekg(start);
+  if (!in || end == std::istream::pos_type(-1) || static_cast<std::uint64_t>(end - start) / kEntryBytes < count)
+    throw std::runtime_error("Matrix import: unexpected end of binary data.");
+  Matrix M(static_cast<std::size_t>(rows), static_cast<std::size_t>(cols));
+  for (std::size_t i = 0; i < rows; ++i)
+    for (std::size_t j = 0; j < cols; ++j) M(i, j) = readEntry(in);
+  return M;
+}
@@ -0,0 +1,58 @@
+// matrix_export.hpp — Streaming Matrix export (CSV, LaTeX, binary) through a reusable buffer.
+// Entries are formatted with std::to_chars straight into the buffer, which is flushed to the
+// output stream whenever it fills, so no per-cell strings are built however large the matrix is.
+//
+// Binary layout (little-endian): "MTXQ", uint32 version (1), uint64 rows, uint64 cols, then
+// rows*cols entries in row-major order, each an int64 numerator followed by an int64 denominator.
+
+#ifndef MATRIX_EXPORT_HPP
+#define MATRIX_EXPORT_HPP
+
+#include "matrix.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+enum class ExportFormat { Csv, Latex, Binary };
+
+class MatrixExporter {
+public:
+  explicit MatrixExporter(std::ostream& out, std::size_t bufferSize = 64 * 1024);
+  ~MatrixExporter();
+  MatrixExporter(const MatrixExporter&) = delete;
+  MatrixExporter& operator=(const MatrixExporter&) = delete;
+
+  // Appends M in the given format; may be called repeatedly (the buffer is reused).
+  void write(const Matrix& M, ExportFormat format);
+  // Hands everything buffered to the stream; throws std::runtime_error if the stream failed.
+  void flush();
+
+private:
+  std::ostream& out_;
+  std::vector<char> buffer_;
+  std::size_t used_;
+
+  char* reserve(std::size_t n);  // pointer to at least n free bytes (flushing first if needed)
+  void append(const char* text, std::size_t n);
+  void appendChar(char c);
+  void appendLiteral(const char* text);
+  void appendFraction(const Fraction& f);
+  void appendUint(std::uint64_t v, std::size_t bytes);
+  void writeCsv(const Matrix& M);
+  void writeLatex(const Matrix& M);
+  void writeBinary(const Matrix& M);
+};
+
+// Convenience wrappers. exportMatrixToFile throws std::runtime_error if the file cannot be written.
+void exportMatrixToFile(const Matrix& M, const std::string& path, ExportFormat format);
+std::string exportMatrixToString(const Matrix& M, ExportFormat format);
+// .csv -> Csv, .tex -> Latex, anything else -> Binary.
+ExportFormat exportFormatForPath(const std::string& path);
+
+// Reads one matrix in the binary layout above; throws std::runtime_error on malformed input,
+// including a header claiming more entries than the stream holds (checked before allocating).
+Matrix importMatrixBinary(std::istream& in);
+
+#endif // MATRIX_EXPORT_HPP
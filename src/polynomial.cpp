@@ -0,0 +1,217 @@
+// polynomial.cpp — Polynomial evaluation, formatting, rational root search and Durand–Kerner approximation.
+
+#include "polynomial.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  const std::int64_t kDivisorLimit = 1000000;  // enumerate all p/q candidates only below this size
+
+  Polynomial trimmed(Polynomial p) {
+    while (p.size() > 1 && p.back().isZero()) p.pop_back();
+    if (p.empty()) p.push_back(Fraction(0, 1));
+    return p;
+  }
+
+  std::int64_t gcd64(std::int64_t a, std::int64_t b) {
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+      std::int64_t t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+
+  // p scaled by the lcm of its denominators; false if that overflows 64 bits.
+  bool integerCoefficients(const Polynomial& p, std::vector<std::int64_t>& out) {
+    std::int64_t lcm = 1;
+    for (const Fraction& c : p) {
+      std::int64_t d = c.denominator();
+      std::int64_t g = gcd64(lcm, d);
+      if (__builtin_mul_overflow(lcm / g, d, &lcm)) return false;
+    }
+    out.clear();
+    for (const Fraction& c : p) {
+      std::int64_t v;
+      if (__builtin_mul_overflow(c.numerator(), lcm / c.denominator(), &v)) return false;
+      out.push_back(v);
+    }
+    return true;
+  }
+
+  // Divides p by (x - r); the remainder is assumed zero.
+  Polynomial deflate(const Polynomial& p, const Fraction& r) {
+    const std::size_t n = p.size() - 1;
+    Polynomial q(n);
+    q[n - 1] = p[n];
+    for (std::size_t k = n - 1; k >= 1; --k)
+      q[k - 1] = p[k] + r * q[k];
+    return q;
+  }
+
+  std::vector<std::int64_t> positiveDivisors(std::int64_t v) {
+    v = v < 0 ? -v : v;
+    std::vector<std::int64_t> divs;
+    for (std::int64_t d = 1; d * d <= v; ++d)
+      if (v % d == 0) {
+        divs.push_back(d);
+        if (d * d != v) divs.push_back(v / d);
+      }
+    return divs;
+  }
+
+  // Continued-fraction convergents p/q of x that lie close to x.
+  std::vector<Fraction> convergents(double x) {
+    std::vector<Fraction> out;
+    const long double target = x;
+    const long double tolerance = 1e-4L * std::max(1.0L, std::fabs(target));
+    long double rest = target;
+    long double h1 = 1, h2 = 0, k1 = 0, k2 = 1;
+    for (int i = 0; i < 40; ++i) {
+      long double a = std::floor(rest);
+      long double h = a * h1 + h2;
+      long double k = a * k1 + k2;
+      if (std::fabs(h) > 1e15L || k > 1e15L) break;
+      if (std::fabs(h / k - target) <= tolerance)
+        out.push_back(Fraction(static_cast<std::int64_t>(h), static_cast<std::int64_t>(k)));
+      long double frac = rest - a;
+      if (frac < 1e-12L) break;
+      rest = 1.0L / frac;
+      h2 = h1;
+      h1 = h;
+      k2 = k1;
+      k1 = k;
+    }
+    return out;
+  }
+}
+
+namespace poly {
+
+std::size_t degree(const Polynomial& p) {
+  return trimmed(p).size() - 1;
+}
+
+Fraction evaluate(const Polynomial& p, const Fraction& x) {
+  Fraction result(0, 1);
+  for (std::size_t i = p.size(); i-- > 0;)
+    result = result * x + p[i];
+  return result;
+}
+
+std::string toString(const Polynomial& p, const std::string& var) {
+  const Polynomial q = trimmed(p);
+  std::string out;
+  for (std::size_t i = q.size(); i-- > 0;) {
+    const Fraction& c = q[i];
+    if (c.isZero() && !(i == 0 && out.empty())) continue;
+    const bool negative = c.numerator() < 0;
+    const Fraction mag = c.abs();
+    if (out.empty())
+      out += negative ? "-" : "";
+    else
+      out += negative ? " - " : " + ";
+    const bool unit = mag == Fraction(1, 1);
+    if (i == 0 || !unit)
+      out += (i != 0 && mag.denominator() != 1) ? "(" + mag.toString() + ")" : mag.toString();
+    if (i >= 1) out += var;
+    if (i >= 2) out += "^" + std::to_string(i);
+  }
+  return out;
+}
+
+RationalRoots rationalRoots(const Polynomial& p) {
+  RationalRoots result;
+  Polynomial q = trimmed(p);
+  while (q.size() > 1 && q[0].isZero()) {
+    result.roots.push_back(Fraction(0, 1));
+    q.erase(q.begin());
+  }
+
+  auto tryRoot = [&](const Fraction& r) {
+    while (q.size() > 1) {
+      std::vector<std::int64_t> ints;
+      if (integerCoefficients(q, ints)) {
+        // Rational root theorem: numerator divides the constant term, denominator the leading one.
+        if (ints.front() % r.numerator() != 0 || ints.back() % r.denominator() != 0) return;
+      }
+      // A candidate whose powers leave 64 bits is not tried further; approximateRoots() still finds it.
+      Polynomial quotient;
+      try {
+        if (!evaluate(q, r).isZero()) return;
+        quotient = deflate(q, r);
+      } catch (const std::overflow_error&) {
+        return;
+      }
+      result.roots.push_back(r);
+      q = std::move(quotient);
+    }
+  };
+
+  std::set<std::pair<std::int64_t, std::int64_t>> tried;
+  auto candidate = [&](const Fraction& r) {
+    if (r.isZero() || !tried.insert({r.numerator(), r.denominator()}).second) return;
+    tryRoot(r);
+  };
+
+  std::vector<std::int64_t> ints;
+  if (q.size() > 1 && integerCoefficients(q, ints)) {
+    const std::int64_t a0 = ints.front() < 0 ? -ints.front() : ints.front();
+    const std::int64_t an = ints.back() < 0 ? -ints.back() : ints.back();
+    if (a0 <= kDivisorLimit && an <= kDivisorLimit)
+      for (std::int64_t num : positiveDivisors(a0))
+        for (std::int64_t den : positiveDivisors(an)) {
+          candidate(Fraction(num, den));
+          candidate(Fraction(-num, den));
+        }
+  }
+  if (q.size() > 1)
+    for (const std::complex<double>& z : approximateRoots(q))
+      if (std::fabs(z.imag()) <= 1e-6 * std::max(1.0, std::abs(z)))
+        for (const Fraction& r : convergents(z.real()))
+          candidate(r);
+
+  result.remainder = q;
+  return result;
+}
+
+std::vector<std::complex<double>> approximateRoots(const Polynomial& p) {
+  const Polynomial q = trimmed(p);
+  const std::size_t n = q.size() - 1;
+  std::vector<std::complex<double>> roots(n);
+  if (n == 0) return roots;
+  std::vector<double> monic(n + 1);
+  const double lead = q[n].toDouble();
+  for (std::size_t i = 0; i <= n; ++i) monic[i] = q[i].toDouble() / lead;
+
+  const std::complex<double> seed(0.4, 0.9);
+  std::complex<double> power(1.0, 0.0);
+  for (std::size_t k = 0; k < n; ++k) {
+    roots[k] = power;
+    power *= seed;
+  }
+  for (int iter = 0; iter < 2000; ++iter) {
+    double maxStep = 0.0;
+    for (std::size_t k = 0; k < n; ++k) {
+      std::complex<double> num(monic[n], 0.0);
+      for (std::size_t i = n; i-- > 0;) num = num * roots[k] + monic[i];
+      std::complex<double> den(1.0, 0.0);
+      for (std::size_t j = 0; j < n; ++j)
+        if (j != k) den *= roots[k] - roots[j];
+      if (std::abs(den) == 0.0) den = std::complex<double>(1e-12, 0.0);
+      const std::complex<double> step = num / den;
+      roots[k] -= step;
+      maxStep = std::max(maxStep, std::abs(step) / (1.0 + std::abs(roots[k])));
+    }
+    if (maxStep < 1e-15) break;
+  }
+  return roots;
+}
+
+} // namespace poly
@@ -0,0 +1,36 @@
+// polynomial.hpp — Polynomials with Fraction coefficients: evaluation, formatting, exact rational roots
+// and floating-point approximations of the remaining (possibly complex) roots.
+
+#ifndef POLYNOMIAL_HPP
+#define POLYNOMIAL_HPP
+
+#include "fraction.hpp"
+#include <complex>
+#include <string>
+#include <vector>
+
+// Coefficients in ascending degree: p(x) = c[0] + c[1] x + ... + c[n] x^n.
+using Polynomial = std::vector<Fraction>;
+
+namespace poly {
+
+std::size_t degree(const Polynomial& p);  // degree of the highest nonzero coefficient (0 for zero)
+Fraction evaluate(const Polynomial& p, const Fraction& x);
+// Display as e.g. "x^3 - 2x^2 + 1/2x - 4" in the variable name given.
+std::string toString(const Polynomial& p, const std::string& var = "x");
+
+// Exact rational roots (with multiplicity) found via the rational root theorem, and the quotient
+// left after dividing them out. Candidates come from small divisors and from rationalizing the
+// floating-point roots, so roots whose numerator/denominator exceed 64 bits may be missed.
+struct RationalRoots {
+  std::vector<Fraction> roots;
+  Polynomial remainder;
+};
+RationalRoots rationalRoots(const Polynomial& p);
+
+// Floating-point approximations of all roots (Durand–Kerner iteration).
+std::vector<std::complex<double>> approximateRoots(const Polynomial& p);
+
+} // namespace poly
+
+#endif // POLYNOMIAL_HPP
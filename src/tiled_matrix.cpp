@@ -0,0 +1,550 @@
+// tiled_matrix.cpp — TiledMatrix implementation: tile file I/O, LRU tile cache with background
+// prefetch, and the tiled multiply and Gauss–Jordan elimination.
+
+#include "tiled_matrix.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <istream>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+  const char kTileMagic[4] = {'M', 'T', 'X', 'T'};
+  const std::uint32_t kTileVersion = 1;
+  const char kBinaryMagic[4] = {'M', 'T', 'X', 'Q'};
+  const std::uint32_t kBinaryVersion = 1;
+  const std::size_t kHeaderBytes = 32;
+  const std::size_t kEntryBytes = 16;
+  // Background reads in flight per matrix; they count against the cache budget.
+  const std::size_t kMaxPrefetch = 2;
+
+  void putUint(unsigned char* p, std::uint64_t v, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+  }
+
+  std::uint64_t getUint(const unsigned char* p, std::size_t bytes) {
+    std::uint64_t v = 0;
+    for (std::size_t i = bytes; i-- > 0;) v = (v << 8) | p[i];
+    return v;
+  }
+
+  // Size of the tile file for a rows×cols matrix in t×t tiles; throws if it overflows a file offset,
+  // so a corrupt or hostile header is refused before anything is sized from it.
+  std::uint64_t fileBytes(std::uint64_t rows, std::uint64_t cols, std::uint64_t t) {
+    const std::uint64_t tileRows = rows / t + (rows % t != 0), tileCols = cols / t + (cols % t != 0);
+    std::uint64_t tiles, tileBytes, bytes;
+    if (__builtin_mul_overflow(tileRows, tileCols, &tiles) || __builtin_mul_overflow(t, t, &tileBytes) ||
+        __builtin_mul_overflow(tileBytes, kEntryBytes, &tileBytes) || __builtin_mul_overflow(tiles, tileBytes, &bytes) ||
+        bytes > static_cast<std::uint64_t>(INT64_MAX) - kHeaderBytes) {
+      std::ostringstream oss;
+      oss << "TiledMatrix: a " << rows << "x" << cols << " matrix in " << t << "x" << t << " tiles is too large.";
+      throw std::invalid_argument(oss.str());
+    }
+    return kHeaderBytes + bytes;
+  }
+
+  // Tiles of `entries` Fractions that fit in budget bytes; checked before any file is opened.
+  std::size_t cacheCapacity(std::size_t budget, std::size_t entries) {
+    const std::size_t tiles = budget / (entries * sizeof(Fraction));
+    if (tiles < TiledMatrix::kMinCachedTiles) {
+      std::ostringstream oss;
+      oss << "TiledMatrix: a memory budget of " << budget << " bytes holds fewer than "
+          << TiledMatrix::kMinCachedTiles << " tiles of " << entries * sizeof(Fraction) << " bytes.";
+      throw std::invalid_argument(oss.str());
+    }
+    return tiles;
+  }
+
+  std::uint64_t readUint(std::istream& in, std::size_t bytes) {
+    unsigned char buf[8];
+    if (!in.read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(bytes)))
+      throw std::runtime_error("TiledMatrix import: unexpected end of binary data.");
+    return getUint(buf, bytes);
+  }
+}
+
+// The cache is used only from the thread that owns the TiledMatrix; background prefetches touch
+// nothing but the file (under ioMutex) and the atomic read counter.
+struct TiledMatrix::Store {
+  struct Slot {
+    std::size_t index;
+    std::vector<Fraction> data;
+    bool dirty;
+  };
+
+  std::string path;
+  std::size_t tileEntries;
+  std::size_t capacity;  // tiles resident plus reads in flight
+  std::fstream file;
+  std::mutex ioMutex;
+  std::list<Slot> lru;   // most recently used first
+  std::unordered_map<std::size_t, std::list<Slot>::iterator> where;
+  std::unordered_map<std::size_t, std::future<std::vector<Fraction>>> inFlight;
+  std::atomic<std::uint64_t> tileReads{0};
+  TileStats stats;
+
+  Store(const std::string& p, std::ios::openmode mode, std::size_t entries, std::size_t budget)
+    : path(p), tileEntries(entries), capacity(cacheCapacity(budget, entries)),
+      file(p, mode | std::ios::in | std::ios::out | std::ios::binary) {
+    if (!file) throw std::runtime_error("TiledMatrix: cannot open " + path + ".");
+  }
+
+  ~Store() {
+    inFlight.clear();  // waits for background reads
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
+
+  // Thread-safe: only the file access is serialized, decoding runs on the caller's thread.
+  std::vector<Fraction> load(std::size_t index) {
+    std::vector<unsigned char> bytes(tileEntries * kEntryBytes);
+    {
+      std::lock_guard<std::mutex> lock(ioMutex);
+      file.seekg(static_cast<std::streamoff>(kHeaderBytes + index * bytes.size()));
+      if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        file.clear();
+        throw std::runtime_error("TiledMatrix: cannot read tile " + std::to_string(index) + " of " + path + ".");
+      }
+    }
+    tileReads.fetch_add(1, std::memory_order_relaxed);
+    std::vector<Fraction> data(tileEntries);
+    for (std::size_t e = 0; e < tileEntries; ++e) {
+      const auto num = static_cast<std::int64_t>(getUint(&bytes[e * kEntryBytes], 8));
+      const auto den = static_cast<std::int64_t>(getUint(&bytes[e * kEntryBytes + 8], 8));
+      if (den == 0 && num != 0)
+        throw std::runtime_error("TiledMatrix: zero denominator in tile " + std::to_string(index) + " of " + path + ".");
+      if (num != 0) data[e] = Fraction(num, den);
+    }
+    return data;
+  }
+
+  void save(std::size_t index, const std::vector<Fraction>& data) {
+    std::vector<unsigned char> bytes(tileEntries * kEntryBytes);
+    for (std::size_t e = 0; e < tileEntries; ++e) {
+      putUint(&bytes[e * kEntryBytes], static_cast<std::uint64_t>(data[e].numerator()), 8);
+      putUint(&bytes[e * kEntryBytes + 8], static_cast<std::uint64_t>(data[e].denominator()), 8);
+    }
+    std::lock_guard<std::mutex> lock(ioMutex);
+    file.seekp(static_cast<std::streamoff>(kHeaderBytes + index * bytes.size()));
+    if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+      file.clear();
+      throw std::runtime_error("TiledMatrix: cannot write tile " + std::to_string(index) + " of " + path + ".");
+    }
+    ++stats.tileWrites;
+  }
+
+  void makeRoom() {
+    while (!lru.empty() && lru.size() + inFlight.size() >= capacity) {
+      Slot& victim = lru.back();
+      if (victim.dirty) save(victim.index, victim.data);
+      where.erase(victim.index);
+      lru.pop_back();
+    }
+  }
+
+  // The tile's entries, valid until the next fetch/prefetch on this Store. With fresh set, a tile
+  // that is not already in memory starts as zeros instead of being read (the caller overwrites it).
+  std::vector<Fraction>& fetch(std::size_t index, bool forWrite, bool fresh = false) {
+    const auto hit = where.find(index);
+    if (hit != where.end()) {
+      ++stats.cacheHits;
+      lru.splice(lru.begin(), lru, hit->second);
+      lru.front().dirty |= forWrite;
+      return lru.front().data;
+    }
+    std::vector<Fraction> data;
+    const auto pending = inFlight.find(index);
+    if (pending != inFlight.end()) {
+      ++stats.prefetchHits;
+      std::future<std::vector<Fraction>> read = std::move(pending->second);
+      inFlight.erase(pending);
+      data = read.get();
+    } else if (fresh) {
+      data.assign(tileEntries, Fraction(0, 1));
+    } else {
+      data = load(index);
+    }
+    makeRoom();
+    lru.push_front(Slot{index, std::move(data), forWrite});
+    where[index] = lru.begin();
+    stats.peakResidentTiles = std::max(stats.peakResidentTiles, lru.size() + inFlight.size());
+    return lru.front().data;
+  }
+
+  void prefetch(std::size_t index) {
+    if (where.count(index) || inFlight.count(index) || inFlight.size() >= kMaxPrefetch) return;
+    makeRoom();
+    if (lru.size() + inFlight.size() >= capacity) return;
+    inFlight.emplace(index, std::async(std::launch::async, [this, index] { return load(index); }));
+    stats.peakResidentTiles = std::max(stats.peakResidentTiles, lru.size() + inFlight.size());
+  }
+
+  void flush() {
+    for (Slot& slot : lru)
+      if (slot.dirty) {
+        save(slot.index, slot.data);
+        slot.dirty = false;
+      }
+    std::lock_guard<std::mutex> lock(ioMutex);
+    file.flush();
+  }
+};
+
+TiledMatrix::TiledMatrix(std::size_t rows, std::size_t cols, std::size_t tileSize, std::unique_ptr<Store> store)
+  : rows_(rows), cols_(cols), tileSize_(tileSize), store_(std::move(store)) {}
+
+TiledMatrix::TiledMatrix(TiledMatrix&&) noexcept = default;
+TiledMatrix& TiledMatrix::operator=(TiledMatrix&&) noexcept = default;
+TiledMatrix::~TiledMatrix() = default;
+
+TiledMatrix TiledMatrix::create(const std::string& path, std::size_t rows, std::size_t cols,
+                                std::size_t tileSize, std::size_t memoryBudget) {
+  if (tileSize == 0) throw std::invalid_argument("TiledMatrix: tile size must be positive.");
+  const std::uint64_t bytes = fileBytes(rows, cols, tileSize);
+  auto store = std::make_unique<Store>(path, std::ios::trunc, tileSize * tileSize, memoryBudget);
+  TiledMatrix m(rows, cols, tileSize, std::move(store));
+  unsigned char header[kHeaderBytes];
+  std::memcpy(header, kTileMagic, sizeof(kTileMagic));
+  putUint(header + 4, kTileVersion, 4);
+  putUint(header + 8, rows, 8);
+  putUint(header + 16, cols, 8);
+  putUint(header + 24, tileSize, 8);
+  std::fstream& file = m.store_->file;
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  // Extend to full size with a single byte at the end; the gap reads back as zeros.
+  if (bytes > kHeaderBytes) {
+    file.seekp(static_cast<std::streamoff>(bytes - 1));
+    file.put('\0');
+  }
+  if (!file.flush()) throw std::runtime_error("TiledMatrix: cannot write " + path + ".");
+  return m;
+}
+
+TiledMatrix TiledMatrix::open(const std::string& path, std::size_t memoryBudget) {
+  std::ifstream in(path, std::ios::binary);
+  unsigned char header[kHeaderBytes];
+  if (!in || !in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+      std::memcmp(header, kTileMagic, sizeof(kTileMagic)) != 0)
+    throw std::runtime_error("TiledMatrix: " + path + " is not a tiled matrix file.");
+  if (getUint(header + 4, 4) != kTileVersion)
+    throw std::runtime_error("TiledMatrix: unsupported version " + std::to_string(getUint(header + 4, 4)) +
+                             " in " + path + ".");
+  const std::size_t rows = getUint(header + 8, 8), cols = getUint(header + 16, 8), t = getUint(header + 24, 8);
+  if (t == 0) throw std::runtime_error("TiledMatrix: zero tile size in " + path + ".");
+  in.seekg(0, std::ios::end);
+  std::uint64_t bytes;
+  try {
+    bytes = fileBytes(rows, cols, t);
+  } catch (const std::invalid_argument&) {
+    throw std::runtime_error("TiledMatrix: " + path + " has an impossible header.");
+  }
+  if (static_cast<std::uint64_t>(in.tellg()) != bytes)
+    throw std::runtime_error("TiledMatrix: " + path + " is truncated.");
+  in.close();
+  return TiledMatrix(rows, cols, t, std::make_unique<Store>(path, std::ios::openmode(), t * t, memoryBudget));
+}
+
+TiledMatrix TiledMatrix::fromMatrix(const Matrix& m, const std::string& path, std::size_t tileSize,
+                                    std::size_t memoryBudget) {
+  TiledMatrix result = create(path, m.rows(), m.cols(), tileSize, memoryBudget);
+  for (std::size_t ti = 0; ti < result.tileRows(); ++ti)
+    for (std::size_t tj = 0; tj < result.tileCols(); ++tj)
+      result.setTile(ti, tj, m.block(ti * tileSize, tj * tileSize, result.tileHeight(ti), result.tileWidth(tj)));
+  return result;
+}
+
+TiledMatrix TiledMatrix::fromBinary(std::istream& in, const std::string& path, std::size_t tileSize,
+                                    std::size_t memoryBudget) {
+  char magic[4];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0)
+    throw std::runtime_error("TiledMatrix import: not a binary matrix (bad magic).");
+  const std::uint64_t version = readUint(in, 4);
+  if (version != kBinaryVersion)
+    throw std::runtime_error("TiledMatrix import: unsupported binary version " + std::to_string(version) + ".");
+  const std::size_t rows = readUint(in, 8);
+  const std::size_t cols = readUint(in, 8);
+  // Refuse a header that promises more entries than a seekable stream holds before creating the file.
+  std::uint64_t count;
+  if (__builtin_mul_overflow(static_cast<std::uint64_t>(rows), static_cast<std::uint64_t>(cols), &count) ||
+      count > static_cast<std::uint64_t>(INT64_MAX) / kEntryBytes)
+    throw std::runtime_error("TiledMatrix import: binary header claims an impossible " + std::to_string(rows) +
+                             "x" + std::to_string(cols) + " matrix.");
+  const std::istream::pos_type start = in.tellg();
+  if (start != std::istream::pos_type(-1)) {
+    in.seekg(0, std::ios::end);
+    const std::istream::pos_type end = in.tellg();
+    in.seekg(start);
+    if (!in || end == std::istream::pos_type(-1) || static_cast<std::uint64_t>(end - start) / kEntryBytes < count)
+      throw std::runtime_error("TiledMatrix import: unexpected end of binary data.");
+  }
+  TiledMatrix result = create(path, rows, cols, tileSize, memoryBudget);
+  std::vector<Fraction> band;
+  for (std::size_t ti = 0; ti < result.tileRows(); ++ti) {
+    const std::size_t h = result.tileHeight(ti);
+    band.assign(h * cols, Fraction(0, 1));
+    for (Fraction& f : band) {
+      const auto num = static_cast<std::int64_t>(readUint(in, 8));
+      const auto den = static_cast<std::int64_t>(readUint(in, 8));
+      if (den == 0) throw std::runtime_error("TiledMatrix import: zero denominator in binary data.");
+      f = Fraction(num, den);
+    }
+    for (std::size_t tj = 0; tj < result.tileCols(); ++tj) {
+      const std::size_t w = result.tileWidth(tj);
+      std::vector<Fraction>& data = result.store_->fetch(result.tileIndex(ti, tj), true, true);
+      for (std::size_t i = 0; i < h; ++i)
+        std::copy_n(band.begin() + static_cast<std::ptrdiff_t>(i * cols + tj * tileSize), w,
+                    data.begin() + static_cast<std::ptrdiff_t>(i * tileSize));
+    }
+  }
+  return result;
+}
+
+const std::string& TiledMatrix::path() const { return store_->path; }
+
+void TiledMatrix::boundsCheck(std::size_t row, std::size_t col) const {
+  if (row >= rows_ || col >= cols_) {
+    std::ostringstream oss;
+    oss << "TiledMatrix index out of range: (" << row << ", " << col << ") for " << rows_ << "x" << cols_;
+    throw std::out_of_range(oss.str());
+  }
+}
+
+std::size_t TiledMatrix::tileHeight(std::size_t ti) const { return std::min(tileSize_, rows_ - ti * tileSize_); }
+std::size_t TiledMatrix::tileWidth(std::size_t tj) const { return std::min(tileSize_, cols_ - tj * tileSize_); }
+
+Fraction TiledMatrix::get(std::size_t row, std::size_t col) const {
+  boundsCheck(row, col);
+  const std::vector<Fraction>& data = store_->fetch(tileIndex(row / tileSize_, col / tileSize_), false);
+  return data[(row % tileSize_) * tileSize_ + col % tileSize_];
+}
+
+void TiledMatrix::set(std::size_t row, std::size_t col, const Fraction& value) {
+  boundsCheck(row, col);
+  std::vector<Fraction>& data = store_->fetch(tileIndex(row / tileSize_, col / tileSize_), true);
+  data[(row % tileSize_) * tileSize_ + col % tileSize_] = value;
+}
+
+Matrix TiledMatrix::tile(std::size_t ti, std::size_t tj) const {
+  if (ti >= tileRows() || tj >= tileCols()) boundsCheck(ti * tileSize_, tj * tileSize_);
+  const std::size_t h = tileHeight(ti), w = tileWidth(tj);
+  const std::vector<Fraction>& data = store_->fetch(tileIndex(ti, tj), false);
+  Matrix m(h, w);
+  for (std::size_t i = 0; i < h; ++i)
+    for (std::size_t j = 0; j < w; ++j) m(i, j) = data[i * tileSize_ + j];
+  return m;
+}
+
+void TiledMatrix::setTile(std::size_t ti, std::size_t tj, const Matrix& m) {
+  if (ti >= tileRows() || tj >= tileCols()) boundsCheck(ti * tileSize_, tj * tileSize_);
+  const std::size_t h = tileHeight(ti), w = tileWidth(tj);
+  if (m.rows() != h || m.cols() != w) {
+    std::ostringstream oss;
+    oss << "TiledMatrix setTile: tile (" << ti << ", " << tj << ") is " << h << "x" << w << ", got "
+        << m.rows() << "x" << m.cols();
+    throw std::invalid_argument(oss.str());
+  }
+  std::vector<Fraction>& data = store_->fetch(tileIndex(ti, tj), true, true);
+  for (std::size_t i = 0; i < h; ++i)
+    for (std::size_t j = 0; j < w; ++j) data[i * tileSize_ + j] = m(i, j);
+}
+
+Matrix TiledMatrix::toMatrix() const {
+  Matrix m(rows_, cols_);
+  const std::size_t tiles = tileRows() * tileCols();
+  for (std::size_t index = 0; index < tiles; ++index) {
+    if (index + 1 < tiles) store_->prefetch(index + 1);
+    const std::size_t ti = index / tileCols(), tj = index % tileCols();
+    const std::vector<Fraction>& data = store_->fetch(index, false);
+    for (std::size_t i = 0; i < tileHeight(ti); ++i)
+      for (std::size_t j = 0; j < tileWidth(tj); ++j)
+        m(ti * tileSize_ + i, tj * tileSize_ + j) = data[i * tileSize_ + j];
+  }
+  return m;
+}
+
+void TiledMatrix::writeBinary(std::ostream& out) const {
+  std::vector<unsigned char> bytes(24);
+  std::memcpy(bytes.data(), kBinaryMagic, sizeof(kBinaryMagic));
+  putUint(&bytes[4], kBinaryVersion, 4);
+  putUint(&bytes[8], rows_, 8);
+  putUint(&bytes[16], cols_, 8);
+  out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  bytes.resize(cols_ * kEntryBytes);
+  std::vector<Fraction> band;
+  for (std::size_t ti = 0; ti < tileRows(); ++ti) {
+    const std::size_t h = tileHeight(ti);
+    band.assign(h * cols_, Fraction(0, 1));
+    for (std::size_t tj = 0; tj < tileCols(); ++tj) {
+      const std::size_t next = tj + 1 < tileCols() ? tileIndex(ti, tj + 1) : tileIndex(ti + 1, 0);
+      if (next < tileRows() * tileCols()) store_->prefetch(next);
+      const std::vector<Fraction>& data = store_->fetch(tileIndex(ti, tj), false);
+      for (std::size_t i = 0; i < h; ++i)
+        std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(i * tileSize_), tileWidth(tj),
+                    band.begin() + static_cast<std::ptrdiff_t>(i * cols_ + tj * tileSize_));
+    }
+    for (std::size_t i = 0; i < h; ++i) {
+      for (std::size_t j = 0; j < cols_; ++j) {
+        putUint(&bytes[j * kEntryBytes], static_cast<std::uint64_t>(band[i * cols_ + j].numerator()), 8);
+        putUint(&bytes[j * kEntryBytes + 8], static_cast<std::uint64_t>(band[i * cols_ + j].denominator()), 8);
+      }
+      out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+  }
+  if (!out) throw std::runtime_error("TiledMatrix export: write failed.");
+}
+
+void TiledMatrix::flush() { store_->flush(); }
+
+TileStats TiledMatrix::stats() const {
+  TileStats s = store_->stats;
+  s.tileReads = store_->tileReads.load(std::memory_order_relaxed);
+  return s;
+}
+
+TiledMatrix TiledMatrix::multiply(const TiledMatrix& other, const std::string& path, std::size_t memoryBudget) const {
+  MATRIX_INSTR_SCOPE("tiled multiply", rows_, other.cols_);
+  if (cols_ != other.rows_ || tileSize_ != other.tileSize_) {
+    std::ostringstream oss;
+    oss << "TiledMatrix multiplication: dimension or tile size mismatch (" << rows_ << "x" << cols_ << " / "
+        << tileSize_ << ") * (" << other.rows_ << "x" << other.cols_ << " / " << other.tileSize_ << ")";
+    throw std::invalid_argument(oss.str());
+  }
+  TiledMatrix result = create(path, rows_, other.cols_, tileSize_, memoryBudget);
+  const std::size_t tk = tileCols();
+  for (std::size_t ti = 0; ti < result.tileRows(); ++ti)
+    for (std::size_t tj = 0; tj < result.tileCols(); ++tj) {
+      Matrix acc(result.tileHeight(ti), result.tileWidth(tj));
+      for (std::size_t k = 0; k < tk; ++k) {
+        // Start reading the next step's operands before this step's product.
+        if (k + 1 < tk) {
+          store_->prefetch(tileIndex(ti, k + 1));
+          other.store_->prefetch(other.tileIndex(k + 1, tj));
+        } else if (tj + 1 < result.tileCols()) {
+          store_->prefetch(tileIndex(ti, 0));
+          other.store_->prefetch(other.tileIndex(0, tj + 1));
+        }
+        const Matrix a = tile(ti, k);
+        const Matrix b = other.tile(k, tj);
+        acc = acc + a * b;
+      }
+      result.setTile(ti, tj, acc);
+    }
+  result.flush();
+  return result;
+}
+
+std::vector<Fraction> TiledMatrix::readPanel(std::size_t tj) const {
+  const std::size_t w = tileWidth(tj);
+  std::vector<Fraction> panel(rows_ * w);
+  for (std::size_t ti = 0; ti < tileRows(); ++ti) {
+    for (std::size_t ahead = 1; ahead <= kMaxPrefetch && ti + ahead < tileRows(); ++ahead)
+      store_->prefetch(tileIndex(ti + ahead, tj));
+    const std::vector<Fraction>& data = store_->fetch(tileIndex(ti, tj), false);
+    for (std::size_t i = 0; i < tileHeight(ti); ++i)
+      std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(i * tileSize_), w,
+                  panel.begin() + static_cast<std::ptrdiff_t>((ti * tileSize_ + i) * w));
+  }
+  // The next panel starts loading while the caller works on this one.
+  if (tj + 1 < tileCols()) store_->prefetch(tileIndex(0, tj + 1));
+  return panel;
+}
+
+void TiledMatrix::writePanel(std::size_t tj, const std::vector<Fraction>& panel) {
+  const std::size_t w = tileWidth(tj);
+  for (std::size_t ti = 0; ti < tileRows(); ++ti) {
+    std::vector<Fraction>& data = store_->fetch(tileIndex(ti, tj), true, true);
+    for (std::size_t i = 0; i < tileHeight(ti); ++i)
+      std::copy_n(panel.begin() + static_cast<std::ptrdiff_t>((ti * tileSize_ + i) * w), w,
+                  data.begin() + static_cast<std::ptrdiff_t>(i * tileSize_));
+  }
+}
+
+namespace {
+  // One pivot of a panel: the swap that brought it to row `row`, the reciprocal that scaled it to 1,
+  // and the multiples of it subtracted from other rows — the same operations for every column.
+  struct PivotStep {
+    std::size_t row;
+    std::size_t swapWith;
+    Fraction inverse;
+    std::vector<std::pair<std::size_t, Fraction>> eliminate;
+  };
+
+  void swapRows(std::vector<Fraction>& a, std::size_t w, std::size_t r, std::size_t s) {
+    std::swap_ranges(a.begin() + static_cast<std::ptrdiff_t>(r * w), a.begin() + static_cast<std::ptrdiff_t>((r + 1) * w),
+                     a.begin() + static_cast<std::ptrdiff_t>(s * w));
+  }
+
+  void subtractRowMultiple(std::vector<Fraction>& a, std::size_t w, std::size_t from, std::size_t target,
+                           const Fraction& f, std::size_t firstCol) {
+    const Fraction* src = &a[from * w];
+    Fraction* dst = &a[target * w];
+    for (std::size_t c = firstCol; c < w; ++c)
+      if (!src[c].isZero()) dst[c] = dst[c] - f * src[c];
+  }
+}
+
+std::size_t TiledMatrix::rrefInPlace() {
+  MATRIX_INSTR_SCOPE("tiled rref", rows_, cols_);
+  const std::size_t n = rows_;
+  std::size_t r = 0;
+  for (std::size_t tc = 0; tc < tileCols() && r < n; ++tc) {
+    const std::size_t w = tileWidth(tc);
+    std::vector<Fraction> panel = readPanel(tc);
+    std::vector<PivotStep> steps;
+    for (std::size_t c = 0; c < w && r < n; ++c) {
+      std::size_t p = n;
+      unsigned best = 0;
+      for (std::size_t i = r; i < n; ++i) {
+        const Fraction& v = panel[i * w + c];
+        if (v.isZero()) continue;
+        const unsigned bits = v.bitSize();
+        if (p == n || bits < best) {
+          p = i;
+          best = bits;
+        }
+      }
+      if (p == n) continue;
+      if (p != r) {
+        MATRIX_INSTR_COUNT(pivotSwaps);
+        swapRows(panel, w, p, r);
+      }
+      PivotStep step{r, p, Fraction(1, 1) / panel[r * w + c], {}};
+      // Row r is zero left of column c: earlier pivot columns were cleared, other columns had no pivot.
+      for (std::size_t j = c + 1; j < w; ++j) panel[r * w + j] = panel[r * w + j] * step.inverse;
+      panel[r * w + c] = Fraction(1, 1);
+      for (std::size_t i = 0; i < n; ++i) {
+        if (i == r || panel[i * w + c].isZero()) continue;
+        const Fraction f = panel[i * w + c];
+        subtractRowMultiple(panel, w, r, i, f, c);
+        step.eliminate.emplace_back(i, f);
+      }
+      steps.push_back(std::move(step));
+      ++r;
+    }
+    writePanel(tc, panel);
+    if (steps.empty()) continue;
+    // Columns left of this panel are zero in every row these steps touch, so only later panels change.
+    for (std::size_t tj = tc + 1; tj < tileCols(); ++tj) {
+      const std::size_t wj = tileWidth(tj);
+      std::vector<Fraction> q = readPanel(tj);
+      for (const PivotStep& step : steps) {
+        if (step.swapWith != step.row) swapRows(q, wj, step.swapWith, step.row);
+        for (std::size_t j = 0; j < wj; ++j) q[step.row * wj + j] = q[step.row * wj + j] * step.inverse;
+        for (const auto& e : step.eliminate) subtractRowMultiple(q, wj, step.row, e.first, e.second, 0);
+      }
+      writePanel(tj, q);
+    }
+  }
+  store_->flush();
+  return r;
+}
@@ -0,0 +1,99 @@
+// tiled_matrix.hpp — Out-of-core matrices for systems that do not fit in memory as one Matrix.
+// Entries live in a file of fixed-size square tiles and pass through an LRU cache bounded by a
+// memory budget; dirty tiles are written back on eviction. While one tile is being computed on,
+// the next one is read on a background thread, so file I/O overlaps with Fraction arithmetic.
+//
+// File layout (little-endian): "MTXT", uint32 version (1), uint64 rows, uint64 cols, uint64 tile
+// size t, then ceil(rows/t) * ceil(cols/t) tiles in row-major tile order, each t*t entries in
+// row-major order (edge tiles padded), each entry an int64 numerator and an int64 denominator.
+// An all-zero entry (denominator 0) reads as 0, so a new matrix only needs its file sized.
+
+#ifndef TILED_MATRIX_HPP
+#define TILED_MATRIX_HPP
+
+#include "matrix.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TileStats {
+  std::uint64_t tileReads = 0;     // tiles read from the file (including prefetches)
+  std::uint64_t tileWrites = 0;    // dirty tiles written back
+  std::uint64_t cacheHits = 0;     // tile requests served from memory
+  std::uint64_t prefetchHits = 0;  // tile requests served by a read already in flight
+  std::size_t peakResidentTiles = 0;
+};
+
+class TiledMatrix {
+public:
+  // A zero rows×cols matrix in a new file at path (replacing any existing file). memoryBudget is
+  // in bytes and bounds the tiles resident or in flight; it must hold at least kMinCachedTiles.
+  // Throws std::invalid_argument if the file would be larger than a file offset can address.
+  static TiledMatrix create(const std::string& path, std::size_t rows, std::size_t cols,
+                            std::size_t tileSize, std::size_t memoryBudget);
+  // Reopens a file written by a TiledMatrix. Throws std::runtime_error if it is not one.
+  static TiledMatrix open(const std::string& path, std::size_t memoryBudget);
+  static TiledMatrix fromMatrix(const Matrix& m, const std::string& path, std::size_t tileSize,
+                                std::size_t memoryBudget);
+  // Streams a matrix in the MatrixExporter binary layout ("MTXQ") into tiles, holding one band of
+  // tileSize rows at a time rather than the whole matrix. A header claiming more entries than a
+  // seekable stream holds is refused before the file is created.
+  static TiledMatrix fromBinary(std::istream& in, const std::string& path, std::size_t tileSize,
+                                std::size_t memoryBudget);
+
+  static constexpr std::size_t kMinCachedTiles = 4;
+
+  TiledMatrix(TiledMatrix&&) noexcept;
+  TiledMatrix& operator=(TiledMatrix&&) noexcept;
+  ~TiledMatrix();  // writes back dirty tiles; the file stays on disk
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t tileSize() const { return tileSize_; }
+  std::size_t tileRows() const { return (rows_ + tileSize_ - 1) / tileSize_; }
+  std::size_t tileCols() const { return (cols_ + tileSize_ - 1) / tileSize_; }
+  const std::string& path() const;
+
+  // Element access goes through the tile cache; prefer the tile-level calls for bulk work.
+  Fraction get(std::size_t row, std::size_t col) const;
+  void set(std::size_t row, std::size_t col, const Fraction& value);
+  // Tile (ti, tj) as a Matrix of its actual extent (edge tiles are smaller than tileSize).
+  Matrix tile(std::size_t ti, std::size_t tj) const;
+  void setTile(std::size_t ti, std::size_t tj, const Matrix& m);
+
+  Matrix toMatrix() const;                    // needs the whole matrix in memory
+  void writeBinary(std::ostream& out) const;  // MatrixExporter binary layout, one band of tiles at a time
+  void flush();                               // writes back every dirty tile
+
+  // this · other into a new file at path; tile sizes must match. Each output tile accumulates
+  // tile products through Matrix::operator* (so integral tiles take the int64 kernels).
+  TiledMatrix multiply(const TiledMatrix& other, const std::string& path, std::size_t memoryBudget) const;
+  // Reduced row echelon form in place (Gauss–Jordan, fewest-bits pivot like PivotPolicy's default);
+  // returns the rank. Works one tile column at a time: pivots are found in that column's panel
+  // and the recorded row operations are replayed on each later tile column. Besides the tile
+  // cache this holds one panel (rows × tileSize entries) and the panel's row multipliers.
+  std::size_t rrefInPlace();
+
+  TileStats stats() const;
+
+private:
+  struct Store;
+  std::size_t rows_;
+  std::size_t cols_;
+  std::size_t tileSize_;
+  std::unique_ptr<Store> store_;
+
+  TiledMatrix(std::size_t rows, std::size_t cols, std::size_t tileSize, std::unique_ptr<Store> store);
+  void boundsCheck(std::size_t row, std::size_t col) const;
+  std::size_t tileIndex(std::size_t ti, std::size_t tj) const { return ti * tileCols() + tj; }
+  std::size_t tileHeight(std::size_t ti) const;
+  std::size_t tileWidth(std::size_t tj) const;
+  // Columns [tj*t, tj*t + width) of every row, row-major, and back.
+  std::vector<Fraction> readPanel(std::size_t tj) const;
+  void writePanel(std::size_t tj, const std::vector<Fraction>& panel);
+};
+
+#endif // TILED_MATRIX_HPP